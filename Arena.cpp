@@ -1,16 +1,80 @@
 #include "Arena.h"
-#include <dlfcn.h>
 #include <cstdlib>
 #include <ctime>
 #include <math.h>
 #include <thread>
 #include <chrono>
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <utility>
+
+// Rounds in a row without damage, movement or robots closing in before the game is called a draw
+constexpr int MAX_STAGNATION_ROUNDS = 100;
+constexpr int PLACEMENT_PROBES = 1000; // random cells tried before a robot's placement scans the board
 
 // Constructor
 Arena::Arena(int rows, int cols)
-: rows(rows), cols(cols), grid(rows, std::vector<Cell>(cols)) 
+: Arena(defaultConfig(rows, cols))
+{
+}
+
+ArenaConfig Arena::defaultConfig(int rows, int cols)
+{
+    ArenaConfig config;
+    config.rows = rows;
+    config.cols = cols;
+    return config;
+}
+
+Arena::Arena(const ArenaConfig& config)
+: rows(config.map ? config.map->rows() : config.rows), cols(config.map ? config.map->cols() : config.cols),
+  maxRounds(config.maxRounds), memoryCap(config.memoryCap), log(!config.verbose ? nullptr : config.log ? config.log : LogSink::standardOutput()),
+  rng(config.seed ? config.seed : static_cast<unsigned>(std::time(nullptr))),
+  map(config.map), mapStyle(config.mapStyle), symmetricMap(config.symmetricMap),
+  grid(config.map ? Grid(Grid::shared(config.map)) : Grid(rows, cols, config.sparseGrid)), jumps(grid), radarCache(cols),
+  checkpointPath(config.checkpointPath), checkpointEvery(config.checkpointPath.empty() ? 0 : config.checkpointEvery)
+{
+    if (log)
+    {
+        logSource = log->open("seed " + std::to_string(config.seed));
+    }
+    if (config.telemetry)
+    {
+        if (config.telemetry->rows() == rows && config.telemetry->cols() == cols)
+        {
+            telemetry = config.telemetry;
+        }
+        else
+        {
+            std::cerr << "Heatmap is " << config.telemetry->rows() << "x" << config.telemetry->cols()
+                      << ", not recording a " << rows << "x" << cols << " game\n";
+        }
+    }
+}
+
+// Uniform random number in [low, high]. Each arena owns its generator so games can run in parallel.
+int Arena::randomInt(int low, int high)
 {
-    std::srand(std::time(nullptr));
+    return std::uniform_int_distribution<int>(low, high)(rng);
+}
+
+// Everything the game prints goes through these. A headless game skips them entirely; otherwise
+// the line is queued as a record and the sink's thread does the formatting and writing.
+void Arena::logEvent(LogEvent event, std::string_view name, int a, int b, int c) const
+{
+    if (log)
+    {
+        log->push(logSource, event, name, a, b, c);
+    }
+}
+
+void Arena::logText(const std::string& text) const
+{
+    if (log)
+    {
+        log->pushText(logSource, text);
+    }
 }
 
 // Load robots from shared libraries
@@ -18,274 +82,494 @@ void Arena::loadRobots(const std::vector<std::string>& robotLibs)
 {
     for (const auto& lib : robotLibs) 
     {
-        void* handle;
-        RobotBase* robot = loadRobot(lib, handle);
-        if (robot) 
+        std::string error;
+        std::shared_ptr<RobotLibrary> library = RobotLibrary::open(lib, error);
+        if (!library || !addRobot(library)) 
         {
-            robotHandles.push_back(handle);
-            robots.push_back(robot);
-            
-            placeRobot(robot);
-
-            int r, c;
-            robot->get_current_location(r, c);
-            std::cout << "Compiling " << lib << " to lib" << robot->m_name << ".so...\n";
-            std::cout << "boundaries: " << rows << ", " << cols << "\n";
-            std::cout << "Loaded robot: " << robot->m_name << " at (" << r << ", " << c << ")\n";
+            std::cerr << "Failed to load robot from library: " << lib << " " << error << "\n";
         }
-        else
+    }
+}
+
+// Load robots whose libraries a registry has already validated
+void Arena::loadRobots(RobotRegistry& registry, const std::vector<int>& robotIds) 
+{
+    for (int id : robotIds) 
+    {
+        std::shared_ptr<RobotLibrary> library = registry.acquire(id);
+        if (!library || !addRobot(library)) 
         {
-            std::cerr << "Failed to load robot from library: " << lib << "\n";
+            std::cerr << "Failed to load robot from library: " << registry.path(id) << "\n";
         }
     }
 }
 
-int Arena::get_robot_index(int row, int col) const
+// Create a robot from a loaded library and drop it into the arena
+bool Arena::addRobot(std::shared_ptr<RobotLibrary> library) 
+{
+    return createRobot(std::move(library), nullptr);
+}
+
+// The same with the move, armor and weapon a tuner picked
+bool Arena::addRobot(std::shared_ptr<RobotLibrary> library, const RobotConfig& config) 
 {
-    for(size_t i = 0; i < robots.size(); i++)
+    return createRobot(std::move(library), &config);
+}
+
+// Take ownership of a robot and place it. Robots built into the program (tests, benchmarks) come in here directly.
+bool Arena::addRobot(RobotBase* robot) 
+{
+    return addRobot(robot, nullptr, openMemoryAccount(memoryCap));
+}
+
+// The robot's heap account is open before its constructor runs, so that's charged to it too
+bool Arena::createRobot(std::shared_ptr<RobotLibrary> library, const RobotConfig* config) 
+{
+    MemoryAccount* account = openMemoryAccount(memoryCap);
+    RobotBase* robot;
+    {
+        MemoryScope charge(account);
+        robot = config ? library->create(*config) : library->create();
+    }
+    if (!robot) 
     {
-        int robotRow, robotCol;
-        robots[i]->get_current_location(robotRow, robotCol);
+        closeMemoryAccount(account);
+        return false;
+    }
 
-        if(robotRow == row && robotCol == col)
+    return addRobot(robot, std::move(library), account);
+}
+
+// False, with the robot deleted, when there's no empty cell left to put it on
+bool Arena::addRobot(RobotBase* robot, std::shared_ptr<RobotLibrary> library, MemoryAccount* account) 
+{
+    int row, col;
+    if (!findEmptyCell(row, col)) 
+    {
+        std::cerr << "No empty cell left for " << robot->m_name << "\n";
         {
-            return static_cast<int>(i);
+            MemoryScope charge(account);
+            delete robot;
         }
+        closeMemoryAccount(account);
+        return false;
     }
-    return -1;
+
+    uint32_t slot = static_cast<uint32_t>(robots.slots());
+    RobotHandle handle = robots.add(robot, std::move(library), symbolFor(slot), account);
+    occupyCell(row, col, handle);
+    robots.moveTo(slot, row, col);
+
+    if (log)
+    {
+        logText("boundaries: " + std::to_string(rows) + ", " + std::to_string(cols) + "\n");
+        logText("Loaded robot: " + robot->m_name + " at (" + std::to_string(robots.row(slot)) + ", "
+                + std::to_string(robots.col(slot)) + ")\n");
+    }
+    return true;
 }
 
-// Place obstacles in the arena
+// The marker a robot gets on the board, by load order
+char Arena::symbolFor(uint32_t slot) const
+{
+    return specialCharacters[slot % specialCharacters.size()];
+}
+
+// Place obstacles in the arena: the configured map, or a freshly generated one
 void Arena::placeObstacles() 
 {
-    int numObstacles = (rows * cols) / 10;
-    for (int i = 0; i < numObstacles; ++i) 
+    if (map) 
+    {
+        // Already there: the grid was built on the map's shared obstacles
+        jumps.build();
+    } 
+    else 
+    {
+        loadObstacles(MapGenerator::generate(rows, cols, mapStyle, symmetricMap, rng));
+    }
+}
+
+// Copy a layout's obstacles onto the board. The layout must be the size of the arena.
+void Arena::loadObstacles(const ObstacleLayout& layout) 
+{
+    for (int r = 0; r < rows; ++r) 
     {
-        int r = rand() % rows;
-        int c = rand() % cols;
-        if (grid[r][c].type == EMPTY) 
+        for (int c = 0; c < cols; ++c) 
         {
-            CellType obstacleType = static_cast<CellType>(rand() % 3 + 1);
-            grid[r][c].type = obstacleType;
+            CellType type = layout.at(r, c);
+            if (type != EMPTY) 
+            {
+                grid.edit(r, c).type = type;
+            }
         }
     }
+    jumps.build();
+    radarCache.clear();
 }
 
 void Arena::announceDeath(const RobotBase* robot) const {
-    std::cout << robot->m_name << " got absolutely destroyed!\n\n";
+    logEvent(LogEvent::Death, robot->m_name);
 }
 
 // Start the battle simulation
-void Arena::startBattle() {
-    int round = 0;
-    int stagnationCounter = 0;
-    const int MAX_STAGNATION_ROUNDS = 100; // Arbitrary threshold
+GameResult Arena::startBattle() {
+    GameTask& task = game();
+    while (task.resume()) {
+    }
+    return finishBattle();
+}
 
-    while (robots.size() > 1 && stagnationCounter < MAX_STAGNATION_ROUNDS && round < 10000) {
-        std::cout << "\n=========== Round " << round << " ===========\n";
-        printArena();
+bool Arena::battleOver() const {
+    return robots.livingCount() <= 1 || stagnationCounter >= MAX_STAGNATION_ROUNDS || round >= maxRounds;
+}
 
-        bool progress = false;
-        std::vector<std::pair<int, int>> prevLocations(robots.size());
-        std::vector<int> prevDistances;
+GameTask& Arena::game() {
+    if (!gameTask.valid()) {
+        gameTask = play();
+    }
+    return gameTask;
+}
 
-        // Track initial robot positions
-        for (size_t i = 0; i < robots.size(); i++) {
-            robots[i]->get_current_location(prevLocations[i].first, prevLocations[i].second);
-        }
+// The game loop. Turn and round state lives in the coroutine frame between phases.
+GameTask Arena::play() {
+    while (!battleOver()) {
+        beginRound();
 
-        for (size_t i = 0; i < robots.size(); i++) {
-            if (robots[i]->get_health() <= 0) 
+        bool progress = false;
+        size_t living = prevRows.size();
+        for (size_t i = 0; i < living; i++) {
+            RobotHandle handle = robots.livingAt(i);
+            uint32_t slot = handle.slot();
+            if (robots.health(slot) <= 0) 
             {
                 continue;
             }
 
-            int prevHealth = robots[i]->get_health();
-            int prevRow = prevLocations[i].first, prevCol = prevLocations[i].second;
+            int prevHealth = robots.health(slot);
+            int prevRow = prevRows[i], prevCol = prevCols[i];
 
-            std::cout << robots[i]->m_name << "'s turn:\t";
-            std::cout << robots[i]->get_health() << "/100\t";
-            std::cout << "(" << prevCol << "," << prevRow <<  ")\n";
+            logEvent(LogEvent::Turn, robots.get(handle)->m_name, prevHealth, prevRow, prevCol);
 
-            simulateTurn(robots[i]);
+            scanRadar(handle);
+            co_yield GamePhase::Radar;
 
-            std::cout << "\n";
+            TurnOrders orders = decideTurn(handle);
+            co_yield GamePhase::Decide;
 
-            int newHealth = robots[i]->get_health();
-            int newRow, newCol;
-            robots[i]->get_current_location(newRow, newCol);
+            resolveTurn(handle, orders);
+            logEvent(LogEvent::EndLine);
 
             // Check if progress was made (damage or movement)
-            if (newHealth < prevHealth || newRow != prevRow || newCol != prevCol) {
+            if (robots.health(slot) < prevHealth || robots.row(slot) != prevRow || robots.col(slot) != prevCol) {
                 progress = true;
             }
+            co_yield GamePhase::Resolve;
         }
 
-        // Calculate proximity changes
-        for (size_t i = 0; i < robots.size(); i++) {
-            for (size_t j = i + 1; j < robots.size(); j++) {
-                int newRow1, newCol1, newRow2, newCol2;
-                robots[i]->get_current_location(newRow1, newCol1);
-                robots[j]->get_current_location(newRow2, newCol2);
+        endRound(progress);
+        co_yield GamePhase::Bookkeeping;
+    }
+}
 
-                int prevDist = std::abs(prevLocations[i].first - prevLocations[j].first) +
-                               std::abs(prevLocations[i].second - prevLocations[j].second);
-                int newDist = std::abs(newRow1 - newRow2) + std::abs(newCol1 - newCol2);
+// Announce the round and note where everyone starts it
+void Arena::beginRound() {
+    logEvent(LogEvent::Round, {}, round);
+    if (log) {
+        PROFILE_SCOPE(profile, PHASE_RENDER);
+        printArena();
+    }
 
-                if (newDist < prevDist) {
-                    progress = true;
-                }
-            }
+    // Positions in turn order, packed so the proximity check in endRound is a tight loop. The
+    // buffers are members so a round allocates nothing once the game is under way.
+    size_t living = robots.livingCount();
+    prevRows.resize(living);
+    prevCols.resize(living);
+    newRows.resize(living);
+    newCols.resize(living);
+    for (size_t i = 0; i < living; i++) {
+        uint32_t slot = robots.livingAt(i).slot();
+        prevRows[i] = robots.row(slot);
+        prevCols[i] = robots.col(slot);
+    }
+}
+
+// After everyone has had a turn: see whether the game is going anywhere, clear away the dead, checkpoint
+void Arena::endRound(bool progress) {
+    // Calculate proximity changes
+    size_t living = prevRows.size();
+    for (size_t i = 0; i < living; i++) {
+        uint32_t slot = robots.livingAt(i).slot();
+        newRows[i] = robots.row(slot);
+        newCols[i] = robots.col(slot);
+    }
+    for (size_t i = 0; i < living && !progress; i++) {
+        for (size_t j = i + 1; j < living; j++) {
+            int prevDist = std::abs(prevRows[i] - prevRows[j]) + std::abs(prevCols[i] - prevCols[j]);
+            int newDist = std::abs(newRows[i] - newRows[j]) + std::abs(newCols[i] - newCols[j]);
+            progress |= newDist < prevDist;
         }
+    }
 
-        // Remove destroyed robots
-        auto it = robots.begin();
-        while (it != robots.end()) {
-            if ((*it)->get_health() <= 0) {
-                int r, c;
-                (*it)->get_current_location(r, c);
-
-                announceDeath(*it);
-
-                grid[r][c].type = DEAD;
-                int botIndex = get_robot_index(r, c);
-                grid[r][c].specialChar = specialCharacters[botIndex];
-                grid[r][c].robot = nullptr;
-                delete *it; // Free the memory of destroyed robots
-                it = robots.erase(it);
-            } else {
-                ++it;
+    // Remove destroyed robots
+    {
+        PROFILE_SCOPE(profile, PHASE_DEATH_CLEANUP);
+        // Removing a robot moves the last one into its place, so only step on past survivors
+        size_t i = 0;
+        while (i < robots.livingCount()) {
+            uint32_t slot = robots.livingAt(i).slot();
+            if (robots.health(slot) > 0) {
+                ++i;
+                continue;
             }
-        }
 
-        stagnationCounter = progress ? 0 : stagnationCounter + 1;
-        ++round;
-        if (robots.size() == 1) {
-            std::cout << "\n=========== Game Over ===========\n";
-            std::cout << "Winner: " << robots.front()->m_name << "!\n";
-            return; // End the game
+            int r = robots.row(slot), c = robots.col(slot);
+
+            announceDeath(robots.livingRobot(i));
+            if (telemetry) {
+                telemetry->add(TELEMETRY_DEATHS, r, c);
+            }
+
+            // The wreck keeps the robot's handle, which is how it shows the robot's marker
+            setCellType(r, c, DEAD);
+            grid.edit(r, c).floor = EMPTY;
+            if (checkpointEvery > 0) {
+                markDirty(r, c);
+            }
+            robots.remove(robots.livingAt(i), round);
         }
     }
 
-    if (robots.size() > 1) {
-        std::cout << "\n=========== Game Over ===========\n";
-        std::cout << "Draw due to stagnation.\n";
-        return;
+    stagnationCounter = progress ? 0 : stagnationCounter + 1;
+    ++round;
+
+    if (checkpointEvery > 0 && round % checkpointEvery == 0) {
+        PROFILE_SCOPE(profile, PHASE_CHECKPOINT);
+        writeCheckpoint();
     }
+    logEvent(LogEvent::Flush);
 }
 
-// Destructor
-Arena::~Arena() 
-{
-    for (void* handle : robotHandles) 
-    {
-        dlclose(handle);
+// Wrap up after the last round
+GameResult Arena::finishBattle() {
+    GameResult result;
+    result.rounds = round;
+    result.finishRound = robots.finishRounds();
+    result.draw = robots.livingCount() != 1;
+    result.profile = profile;
+    for (uint32_t slot = 0; slot < robots.slots(); ++slot) {
+        result.memory.push_back(memoryUse(robots.account(slot)));
+    }
+
+    logText("\n=========== Game Over ===========\n");
+    if (robots.livingCount() == 1) {
+        logText("Winner: " + robots.livingRobot(0)->m_name + "!\n");
+    } else if (robots.livingCount() > 1) {
+        logText("Draw due to stagnation.\n");
+    } else {
+        logText("Draw - no robot survived.\n");
     }
+    logEvent(LogEvent::Close);
+    if (telemetry) {
+        telemetry->addGame();
+    }
+
+    // Survivors share first place, everyone else is ranked by how long they lasted
+    for (size_t i = 0; i < robots.livingCount(); ++i) {
+        result.placement.push_back(static_cast<int>(robots.livingAt(i).slot()));
+    }
+    std::sort(result.placement.begin(), result.placement.end());
+    std::vector<int> fallen;
+    for (size_t slot = 0; slot < result.finishRound.size(); ++slot) {
+        if (result.finishRound[slot] >= 0) {
+            fallen.push_back(static_cast<int>(slot));
+        }
+    }
+    std::stable_sort(fallen.begin(), fallen.end(), [&](int a, int b) {
+        return result.finishRound[a] > result.finishRound[b];
+    });
+    result.placement.insert(result.placement.end(), fallen.begin(), fallen.end());
+
+    return result;
 }
 
-// Load a robot from a shared library
-RobotBase* Arena::loadRobot(const std::string& sharedLib, void*& handle) 
+// Where a new robot goes: a random empty cell. Random probes find one straight away on any board
+// with room to spare; one that keeps missing gets scanned instead, and false means it's full.
+bool Arena::findEmptyCell(int& row, int& col) 
 {
-    handle = dlopen(sharedLib.c_str(), RTLD_LAZY);
-    if (!handle) 
+    for (int probe = 0; probe < PLACEMENT_PROBES; ++probe) 
     {
-        std::cerr << "Failed to load " << sharedLib << ": " << dlerror() << '\n';
-        return nullptr;
+        row = randomInt(0, rows - 1);
+        col = randomInt(0, cols - 1);
+        if (grid.at(row, col).type == EMPTY) 
+        {
+            return true;
+        }
     }
 
-    // Locate the factory function to create the robot and 'assign' it to this 'create_robot' function.
-    using RobotFactory = RobotBase* (*)();
-    RobotFactory create_robot = (RobotFactory)dlsym(handle, "create_robot");
-    if (!create_robot) 
+    std::vector<std::pair<int, int>> empty;
+    for (int r = 0; r < rows; ++r) 
     {
-        std::cerr << "Failed to find create_robot in " << sharedLib << ": " << dlerror() << '\n';
-        dlclose(handle);
-        return nullptr;
+        for (int c = 0; c < cols; ++c) 
+        {
+            if (grid.at(r, c).type == EMPTY) 
+            {
+                empty.emplace_back(r, c);
+            }
+        }
     }
-
-    // Instantiate the robot - it will need to be deleted later. This actually calls the function that exists
-    // in the ROBOT code! Cool huh! It's in the bottom of the Robot where it says extern "C"
-    RobotBase* robot = create_robot();
-    if (!robot) 
+    if (empty.empty()) 
     {
-        std::cerr << "Failed to create robot instance from " << sharedLib << '\n';
-        dlclose(handle);
-        return nullptr;
+        return false;
     }
-
-    return robot;
+    std::tie(row, col) = empty[randomInt(0, static_cast<int>(empty.size()) - 1)];
+    return true;
 }
 
-// Place a robot in the arena
-void Arena::placeRobot(RobotBase* robot) 
+// Simulate a robot's turn, all three phases at once
+void Arena::simulateTurn(RobotHandle handle) 
 {
-    int r, c;
-    do 
-    {
-        r = rand() % rows;
-        c = rand() % cols;
-    } while (grid[r][c].type != EMPTY);
-
-    grid[r][c].type = ROBOT;
-    grid[r][c].robot = robot;
-    robot->move_to(r, c);
+    scanRadar(handle);
+    resolveTurn(handle, decideTurn(handle));
 }
 
-// Simulate a robot's turn
-void Arena::simulateTurn(RobotBase* robot) 
+// Radar phase: the robot picks a direction and is shown what's there
+void Arena::scanRadar(RobotHandle handle) 
 {
+    RobotBase* robot = robots.get(handle);
+    uint32_t slot = handle.slot();
     int radarDir = 0;
-    robot->get_radar_direction(radarDir);
-    std::cout << "Radar Directions:" << radarDir << "\n";
+    {
+        PROFILE_SCOPE(profile, PHASE_ROBOT_RADAR_DIRECTION);
+        MemoryScope charge(robots.account(slot));
+        robot->get_radar_direction(radarDir);
+    }
+    if (!withinMemoryCap(slot)) {
+        return;
+    }
+    logEvent(LogEvent::RadarDirection, {}, radarDir);
     
-    std::vector<RadarObj> radarResults = simulateRadar(robot, radarDir);
-    robot->process_radar_results(radarResults);
+    const std::vector<RadarObj>& radarResults = simulateRadar(handle, radarDir);
+    {
+        PROFILE_SCOPE(profile, PHASE_ROBOT_PROCESS_RADAR);
+        MemoryScope charge(robots.account(slot));
+        robot->process_radar_results(radarResults);
+    }
+    withinMemoryCap(slot);
 
-    std::cout << "Radar Results for " << robot->m_name << ": ";
-    for (const auto& obj : radarResults) {
-        if(obj.m_type == '.')
+    if (log) {
+        logEvent(LogEvent::RadarResults, robot->m_name);
+        for (const auto& obj : radarResults) {
+            if(obj.m_type == '.')
+            {
+                continue;
+            }
+            logEvent(LogEvent::RadarObject, {}, obj.m_type, obj.m_row, obj.m_col);
+        }
+        logEvent(LogEvent::EndLine);
+    }
+}
+
+// Decide phase: a shot if the robot wants one, otherwise a move. Nothing on the board changes.
+Arena::TurnOrders Arena::decideTurn(RobotHandle handle) 
+{
+    RobotBase* robot = robots.get(handle);
+    uint32_t slot = handle.slot();
+    TurnOrders orders;
+    if (robots.health(slot) <= 0) 
+    {
+        return orders; // shut down over its memory cap, it does nothing
+    }
+    {
+        PROFILE_SCOPE(profile, PHASE_ROBOT_SHOT_LOCATION);
+        MemoryScope charge(robots.account(slot));
+        orders.shooting = robot->get_shot_location(orders.shotRow, orders.shotCol);
+    }
+    if (!withinMemoryCap(slot)) 
+    {
+        return TurnOrders();
+    }
+    if (!orders.shooting) 
+    {
         {
-            continue;
+            PROFILE_SCOPE(profile, PHASE_ROBOT_MOVE_DIRECTION);
+            MemoryScope charge(robots.account(slot));
+            robot->get_move_direction(orders.moveDir, orders.moveDist);
         }
-        std::cout << " Type: " << obj.m_type << " (" << obj.m_col << ", " << obj.m_row <<  ")  ";
+        if (!withinMemoryCap(slot)) 
+        {
+            return TurnOrders();
+        }
+    }
+    return orders;
+}
+
+// A robot whose heap has gone over the cap is shut down as soon as the callback that did it
+// returns: its health goes to zero, it gets no more calls, and it's cleared away with the
+// round's dead. False once that has happened.
+bool Arena::withinMemoryCap(uint32_t slot) 
+{
+    if (!overMemoryCap(robots.account(slot))) 
+    {
+        return true;
+    }
+    if (robots.health(slot) > 0) 
+    {
+        logEvent(LogEvent::OverMemoryCap, robots.get(robots.handle(slot))->m_name,
+                 static_cast<int>(std::min<int64_t>(memoryCap / 1024, INT32_MAX)));
+        robots.takeDamage(slot, robots.health(slot));
+    }
+    return false;
+}
+
+// Resolve phase: carry out the shot or the move
+void Arena::resolveTurn(RobotHandle handle, const TurnOrders& orders) 
+{
+    RobotBase* robot = robots.get(handle);
+    if (robots.health(handle.slot()) <= 0) 
+    {
+        return; // shut down over its memory cap
     }
-    std::cout << "\n";
 
     // Shooting
-    int shotRow, shotCol;
-    if (robot->get_shot_location(shotRow, shotCol)) 
+    if (orders.shooting) 
     {
-        std::cout << "Shooting: " << robot->m_name << " shoots at (" << shotCol << ", " << shotRow << ")\n";
-        resolveShot(robot, shotRow, shotCol);
+        logEvent(LogEvent::Shooting, robot->m_name, 0, orders.shotRow, orders.shotCol);
+        resolveShot(handle, orders.shotRow, orders.shotCol);
         return;
     }
 
-    
-
     // Movement
-    int moveDir = 0, moveDist = 0;
-    robot->get_move_direction(moveDir, moveDist);
-    int row, col;
-    robot->get_current_location(row, col);
-    if(grid[row][col].type == OBSTACLE_PIT)
+    if(robots.moveSpeed(handle.slot()) == 0)
     {
-        std::cout << robot->m_name << " is trapped in a pit and cannot move!\n";
+        logEvent(LogEvent::Trapped, robot->m_name);
         return;
     }
-    if(moveDist > 0)
+    if(orders.moveDist > 0)
     {
-        moveRobot(robot, moveDir, moveDist);
-        int col, row;
-        robot->get_current_location(row, col);
-        std::cout << robot->m_name << " moves to (" << row << ", " << col << ")\n";
+        moveRobot(handle, orders.moveDir, orders.moveDist);
+        logEvent(LogEvent::Moves, robot->m_name, 0, robots.row(handle.slot()), robots.col(handle.slot()));
     }
 }
 
 // Simulate radar results
-std::vector<RadarObj> Arena::simulateRadar(RobotBase* robot, int radarDir) {
-    int row, col;
-    robot->get_current_location(row, col);
-    std::vector<RadarObj> radarResults;
+// The results go in a buffer the arena keeps, so a turn doesn't allocate one, and from there into
+// the radar cache: the same scan from the same cell is answered from it until the ray changes.
+const std::vector<RadarObj>& Arena::simulateRadar(RobotHandle handle, int radarDir) {
+    PROFILE_SCOPE(profile, PHASE_RADAR);
+    int originRow = robots.row(handle.slot());
+    int originCol = robots.col(handle.slot());
+    bool cacheable = radarDir >= 1 && radarDir <= 8;
+    if (cacheable) {
+        if (const std::vector<RadarObj>* cached = radarCache.find(originRow, originCol, radarDir)) {
+            PROFILE_COUNT(profile.radarCache.hits, 1);
+            return *cached;
+        }
+        PROFILE_COUNT(profile.radarCache.misses, 1);
+    }
+
+    int row = originRow;
+    int col = originCol;
+    radarResults.clear();
 
     while (true) {
         auto [newRow, newCol] = getNextCell(row, col, radarDir);
@@ -293,7 +577,7 @@ std::vector<RadarObj> Arena::simulateRadar(RobotBase* robot, int radarDir) {
         // Check for out-of-bounds
         if (newRow < 0 || newRow >= rows || newCol < 0 || newCol >= cols) break;
 
-        Cell& cell = grid[newRow][newCol];
+        const Cell& cell = grid.at(newRow, newCol);
 
         // Determine the type of object detected
         char objTypeChar = '.'; // Default to empty
@@ -339,16 +623,22 @@ std::vector<RadarObj> Arena::simulateRadar(RobotBase* robot, int radarDir) {
         col = newCol;
     }
 
-    return radarResults;
+    return cacheable ? radarCache.store(originRow, originCol, radarDir, radarResults) : radarResults;
 }
 
-// Resolve a shot
-void Arena::resolveShot(RobotBase* shooter, int targetRow, int targetCol) {
-    std::cout << "Resolving shot at (" << targetCol << "," << targetRow << ")\n";
+// Resolve a shot. Everything that can refuse it is checked up front from the robot table and
+// weaponSpecs, so a shot that can't be fired costs a few compares and never reaches the kernel.
+void Arena::resolveShot(RobotHandle shooter, int targetRow, int targetCol) {
+    logEvent(LogEvent::ResolvingShot, {}, 0, targetRow, targetCol);
 
-    int shooterRow, shooterCol;
-    int shooterWeapon = shooter->get_weapon();
-    shooter->get_current_location(shooterRow, shooterCol);
+    uint32_t slot = shooter.slot();
+    int shooterWeapon = robots.weapon(slot);
+    if (shooterWeapon < 0 || shooterWeapon >= weaponCount) {
+        return;
+    }
+    PROFILE_SCOPE(profile, PHASE_SHOT_FLAMETHROWER + shooterWeapon);
+    int shooterRow = robots.row(slot);
+    int shooterCol = robots.col(slot);
     if (targetRow == shooterRow && targetCol == shooterCol) {
         return;
     }
@@ -357,153 +647,269 @@ void Arena::resolveShot(RobotBase* shooter, int targetRow, int targetCol) {
         return;
     }
 
-    switch (shooterWeapon) {
-        case 0: { // Flamethrower
-            for (int r = targetRow - 2; r <= targetRow + 2; ++r) {
-                for (int c = targetCol - 2; c <= targetCol + 2; ++c) {
-                    applyDamageToCell(r, c, 30 + rand() % 21);
-                }
-            }
-            break;
-        }
-        case 1: { // Railgun
-            for (int c = 0; c < cols; ++c) {
-                applyDamageToCell(targetRow, c, 10 + rand() % 11);
-            }
-            break;
+    const WeaponSpec& spec = weaponSpecs[shooterWeapon];
+    if (spec.range > 0 && std::max(std::abs(targetRow - shooterRow), std::abs(targetCol - shooterCol)) > spec.range) {
+        logEvent(LogEvent::OutOfRange, spec.name, spec.range);
+        return;
+    }
+    if (spec.usesGrenades) {
+        if (robots.grenades(slot) <= 0) {
+            logEvent(LogEvent::OutOfAmmo, robots.get(shooter)->m_name);
+            return;
         }
-        case 2: { // Hammer
-            if (abs(targetRow - shooterRow) <= 1 && abs(targetCol - shooterCol) <= 1) {
-                applyDamageToCell(targetRow, targetCol, 50 + rand() % 11);
-            } else {
-                std::cerr << "Hammer can only target adjacent cells.\n";
+        robots.useGrenade(slot);
+    }
+
+    fire(shooterWeapon, shooterRow, shooterCol, targetRow, targetCol);
+}
+
+// The weapon's kernel, no questions asked
+void Arena::fire(int weapon, int shooterRow, int shooterCol, int targetRow, int targetCol) {
+    // One kernel per weapon, picked by WeaponType
+    static constexpr auto kernels = []<size_t... W>(std::index_sequence<W...>) {
+        return std::array<void (Arena::*)(int, int, int, int), sizeof...(W)>{
+            &Arena::fireWeapon<static_cast<WeaponType>(W)>...
+        };
+    }(std::make_index_sequence<weaponCount>{});
+
+    (this->*kernels[weapon])(shooterRow, shooterCol, targetRow, targetCol);
+}
+
+// Everything about the weapon is a compile time constant in here
+template <WeaponType W>
+void Arena::fireWeapon(int shooterRow, int shooterCol, int targetRow, int targetCol) {
+    constexpr WeaponSpec spec = weaponSpecs[W];
+
+    if constexpr (spec.shape == ShotShape::Ray) {
+        // Side lanes sit across the longer axis of the shot, like the 3 wide radar beam
+        int dRow = targetRow - shooterRow;
+        int dCol = targetCol - shooterCol;
+        int sideRow = std::abs(dCol) >= std::abs(dRow) ? 1 : 0;
+        int sideCol = 1 - sideRow;
+
+        constexpr int half = spec.rayWidth / 2;
+        bool laneOpen[spec.rayWidth];
+        std::fill(laneOpen, laneOpen + spec.rayWidth, true);
+        int steps = spec.rayLength ? spec.rayLength : std::max(rows, cols);
+
+        rays.walk(dRow, dCol, steps, [&](int stepRow, int stepCol) {
+            int row = shooterRow + stepRow;
+            int col = shooterCol + stepCol;
+            if (row < 0 || row >= rows || col < 0 || col >= cols) {
+                return false; // reached the edge
             }
-            break;
-        }
-        case 3: {// Grenade
-            for (int r = targetRow - 1; r <= targetRow + 1; ++r) {
-                for (int c = targetCol - 1; c <= targetCol + 1; ++c) {
-                    applyDamageToCell(r, c, 10 + rand() % 31);
+            for (int lane = 0; lane < spec.rayWidth; ++lane) {
+                int r = row + (lane - half) * sideRow;
+                int c = col + (lane - half) * sideCol;
+                if (!laneOpen[lane] || r < 0 || r >= rows || c < 0 || c >= cols) {
+                    continue;
+                }
+                if constexpr (!spec.passesBlockers) {
+                    laneOpen[lane] = !isBlocker(grid.at(r, c).type);
                 }
+                applyDamageToCell(r, c, spec.damageMin, spec.damageMax);
             }
-            break;
+            return true;
+        });
+    } else {
+        for (int i = 0; i < spec.patternSize; ++i) {
+            applyDamageToCell(targetRow + spec.pattern[i].row, targetCol + spec.pattern[i].col,
+                              spec.damageMin, spec.damageMax);
         }
     }
 }
 
-void Arena::applyDamageToCell(int row, int col, int baseDamage)
+// Damage is only rolled when a robot is actually hit - most cells on a long shot are empty
+void Arena::applyDamageToCell(int row, int col, int damageMin, int damageMax)
 {
     if(row < 0 || row >= rows || col < 0 || col >= cols) return;
 
-    Cell& targetCell = grid[row][col];
-    if (targetCell.type == ROBOT && targetCell.robot) {
-        std::cout << "Hit robot: " << targetCell.robot->m_name << "\n";
-        int damage = baseDamage * (1 - 0.1 * std::min(targetCell.robot->get_armor(), 4));
-
-        targetCell.robot->take_damage(damage);
-        targetCell.robot->reduce_armor(1);
+    const Cell& targetCell = grid.at(row, col);
+    RobotBase* target = targetCell.type == ROBOT ? robots.get(targetCell.robot) : nullptr;
+    if (target) {
+        uint32_t slot = targetCell.robot.slot();
+        logEvent(LogEvent::HitRobot, target->m_name);
+        int damage = armorReducedDamage(randomInt(damageMin, damageMax), robots.armor(slot));
+
+        int before = robots.health(slot);
+        int lost = before - robots.takeDamage(slot, damage);
+        if (telemetry) {
+            telemetry->add(TELEMETRY_DAMAGE, row, col, static_cast<uint64_t>(lost));
+        }
+        robots.reduceArmor(slot, 1);
 
-        if (targetCell.robot->get_health() <= 0) {
-            std::cout << targetCell.robot->m_name << " is destroyed!\n";
-            targetCell.type = EMPTY;
-            targetCell.robot = nullptr;
+        if (robots.health(slot) <= 0) {
+            logEvent(LogEvent::Destroyed, target->m_name);
+            grid.edit(row, col).floor = EMPTY;
+            setCellType(row, col, DEAD);
         }
     } else if (targetCell.type != EMPTY) {
-        std::cout << "Shot hit an obstacle: ";
-        if (targetCell.type == OBSTACLE_FLAMETHROWER) std::cout << "Flamethrower\n";
-        else if (targetCell.type == OBSTACLE_PIT) std::cout << "Pit\n";
-        else if (targetCell.type == OBSTACLE_MOUND) std::cout << "Mound\n";
+        logEvent(LogEvent::HitObstacle, {}, targetCell.type);
     }
 }
 
-void Arena::moveRobot(RobotBase* robot, int direction, int distance) {
-    int row, col;
-    robot->get_current_location(row, col);
+void Arena::moveRobot(RobotHandle handle, int direction, int distance) {
+    PROFILE_SCOPE(profile, PHASE_MOVE);
+    if (direction < 1 || direction > 8 || distance <= 0) {
+        return;
+    }
 
-    for (int i = 0; i < distance; ++i) {
-        auto [newRow, newCol] = getNextCell(row, col, direction);
+    RobotBase* robot = robots.get(handle);
+    uint32_t slot = handle.slot();
+    int row = robots.row(slot);
+    int col = robots.col(slot);
+    int dRow = directions[direction].first;
+    int dCol = directions[direction].second;
+
+    // Robots may ask for more than they are allowed
+    distance = std::min(distance, robots.moveSpeed(slot));
+
+    // How far it gets before something stops it, and whether a pit comes first
+    int steps = std::min(distance, jumps.freeSteps(direction, row, col));
+    bool trapped = jumps.stepsToPit(direction, row, col) <= steps;
+    if (trapped) {
+        steps = jumps.stepsToPit(direction, row, col);
+    } else if (steps < distance) {
+        int blockRow = row + (steps + 1) * dRow;
+        int blockCol = col + (steps + 1) * dCol;
+        if (blockRow < 0 || blockRow >= rows || blockCol < 0 || blockCol >= cols) {
+            logEvent(LogEvent::OutOfBounds, robot->m_name);
+        } else {
+            if (telemetry) {
+                telemetry->add(TELEMETRY_BLOCKS, blockRow, blockCol);
+            }
+            if (grid.at(blockRow, blockCol).type == OBSTACLE_MOUND) {
+                logEvent(LogEvent::HitMound, robot->m_name);
+            } else if (grid.at(blockRow, blockCol).type == DEAD) {
+                logEvent(LogEvent::HitWreck, robot->m_name);
+            } else {
+                logEvent(LogEvent::Collided, robot->m_name);
+            }
+        }
+    }
 
-        if (newRow < 0 || newRow >= rows || newCol < 0 || newCol >= cols) {
-            std::cerr << robot->m_name << " attempted to move out of bounds.\n";
-            break;
+    // Every flamethrower crossed burns, hop from one to the next
+    for (int f = jumps.stepsToFlame(direction, row, col); f <= steps;
+         f += jumps.stepsToFlame(direction, row + f * dRow, col + f * dCol)) {
+        logEvent(LogEvent::FlameDamage, robot->m_name);
+        int damage = randomInt(30, 50); // Flamethrower damage
+        int before = robots.health(slot);
+        int lost = before - robots.takeDamage(slot, damage);
+        if (telemetry) {
+            telemetry->add(TELEMETRY_FLAMES, row + f * dRow, col + f * dCol);
+            telemetry->add(TELEMETRY_DAMAGE, row + f * dRow, col + f * dCol, static_cast<uint64_t>(lost));
         }
+    }
 
-        Cell& nextCell = grid[newRow][newCol];
-        if (nextCell.type == OBSTACLE_PIT) {
-            std::cerr << robot->m_name << " fell into a pit and is stuck!\n";
-            return; // Robot cannot move further
-        } else if (nextCell.type == OBSTACLE_FLAMETHROWER) {
-            std::cerr << robot->m_name << " took flamethrower damage!\n";
-            robot->take_damage(30 + rand() % 21); // Flamethrower damage
-        } else if (nextCell.type == OBSTACLE_MOUND) {
-            std::cerr << robot->m_name << " hit a mound and cannot move there!\n";
-            break;
-        } else if (nextCell.type == DEAD) {
-            std::cerr << robot->m_name << " hit a dead robot and cannot move there!\n";
-            break;
-        } else if (nextCell.type == ROBOT) {
-            std::cerr << robot->m_name << " collided with another robot.\n";
-            break;
+    if (steps > 0) {
+        vacateCell(row, col);
+        row += steps * dRow;
+        col += steps * dCol;
+        occupyCell(row, col, handle);
+        if (telemetry) {
+            telemetry->add(TELEMETRY_VISITS, row, col);
         }
+    }
 
-        grid[row][col].type = EMPTY;
-        grid[row][col].robot = nullptr;
+    if (trapped) {
+        logEvent(LogEvent::FellInPit, robot->m_name);
+        robots.disableMovement(slot);
+        if (telemetry) {
+            telemetry->add(TELEMETRY_PITS, row, col);
+        }
+    }
 
-        row = newRow;
-        col = newCol;
+    robots.moveTo(slot, row, col);
+}
 
-        grid[row][col].type = ROBOT;
-        grid[row][col].robot = robot;
+// Every change to a cell's type goes through here so the jump tables stay in sync
+void Arena::setCellType(int row, int col, CellType type) {
+    if (grid.at(row, col).type != type) {
+        grid.edit(row, col).type = type;
+        jumps.cellChanged(row, col);
+        [[maybe_unused]] int dropped = radarCache.cellChanged(row, col);
+        PROFILE_COUNT(profile.radarCache.invalidations, static_cast<uint64_t>(dropped));
+        if (checkpointEvery > 0) {
+            markDirty(row, col);
+        }
     }
+}
 
-    robot->move_to(row, col);
+// Remember a changed cell for the next incremental checkpoint
+void Arena::markDirty(int row, int col) {
+    dirtyCells.push_back(static_cast<int64_t>(row) * cols + col);
 }
 
+// A robot leaves a cell, uncovering whatever it was standing on
+void Arena::vacateCell(int row, int col) {
+    Cell& cell = grid.edit(row, col);
+    cell.robot = RobotHandle();
+    setCellType(row, col, cell.floor);
+    cell.floor = EMPTY;
+}
+
+void Arena::occupyCell(int row, int col, RobotHandle handle) {
+    Cell& cell = grid.edit(row, col);
+    cell.floor = cell.type == OBSTACLE_PIT || cell.type == OBSTACLE_FLAMETHROWER ? cell.type : EMPTY;
+    cell.robot = handle;
+    setCellType(row, col, ROBOT);
+}
+
+// The board goes to the log as one block of text
 void Arena::printArena() const {
+    std::string board;
 
-    std::cout << "Legend:\n";
-    std::cout << ".: Empty  ";
-    std::cout << "F: Flamethrower  ";
-    std::cout << "P: Pit  ";
-    std::cout << "M: Mound  ";
-    std::cout << "R: Robot  ";
-    std::cout << "X: Destroyed Robot\n\n";
+    board += "Legend:\n";
+    board += ".: Empty  ";
+    board += "F: Flamethrower  ";
+    board += "P: Pit  ";
+    board += "M: Mound  ";
+    board += "R: Robot  ";
+    board += "X: Destroyed Robot\n\n";
 
     // Print column headers
-    std::cout << "    "; // Padding for row headers
+    board += "    "; // Padding for row headers
     for (int c = 0; c < cols; ++c) {
-        std::cout << c << (c < 10 ? "  " : " "); // Align single- and double-digit numbers
+        board += std::to_string(c) + (c < 10 ? "  " : " "); // Align single- and double-digit numbers
     }
 
-    std::cout << "\n   +" << std::string(cols * 3 + 1, '-') << "+\n";
+    board += "\n   +" + std::string(cols * 3 + 1, '-') + "+\n";
 
     // Print rows
     for (int r = 0; r < rows; ++r) {
         // Print row header
-        std::cout << (r < 10 ? " " : "") << r << " | "; // Align single- and double-digit row numbers
+        board += (r < 10 ? " " : "") + std::to_string(r) + " | "; // Align single- and double-digit row numbers
 
         // Print row content
         for (int c = 0; c < cols; ++c) {
-            switch (grid[r][c].type) {
-                case EMPTY: std::cout << ".  "; break;
-                case OBSTACLE_FLAMETHROWER: std::cout << "F  "; break;
-                case OBSTACLE_PIT: std::cout << "P  "; break;
-                case OBSTACLE_MOUND: std::cout << "M  "; break;
+            const Cell& cell = grid.at(r, c);
+            switch (cell.type) {
+                case EMPTY: board += ".  "; break;
+                case OBSTACLE_FLAMETHROWER: board += "F  "; break;
+                case OBSTACLE_PIT: board += "P  "; break;
+                case OBSTACLE_MOUND: board += "M  "; break;
                 case ROBOT:
-                    if (grid[r][c].robot) {
-                        int botIndex = get_robot_index(r, c);
-                        std::cout << "R" << specialCharacters[botIndex] << " ";
+                    if (cell.robot) {
+                        board += 'R';
+                        board += robots.symbol(cell.robot.slot());
+                        board += ' ';
                     } else {
-                        std::cout << ".  ";
+                        board += ".  ";
                     }
                     break;
-                case DEAD: std::cout << "X" << grid[r][c].specialChar << " "; break;
-                default: std::cout << ".  "; break;
+                case DEAD:
+                    board += 'X';
+                    board += cell.robot ? robots.symbol(cell.robot.slot()) : ' ';
+                    board += ' ';
+                    break;
+                default: board += ".  "; break;
             }
         }
-        std::cout << "|\n"; // Double space for row separation
+        board += "|\n"; // Double space for row separation
     }
-    std::cout << "   +" << std::string(cols * 3 + 1, '-') << "+\n\n";
+    board += "   +" + std::string(cols * 3 + 1, '-') + "+\n\n";
+
+    logText(board);
 }
 
 std::pair<int, int> Arena::getNextCell(int row, int col, int radarDir) {
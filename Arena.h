@@ -4,51 +4,167 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <random>
+#include <memory>
 #include "RobotBase.h"
+#include "Grid.h"
+#include "RobotRegistry.h"
+#include "RobotTable.h"
+#include "ArenaProfile.h"
+#include "Weapons.h"
+#include "LineOfFire.h"
+#include "JumpTables.h"
+#include "ObstacleLayout.h"
+#include "MapGenerator.h"
+#include "LogSink.h"
+#include "GameTask.h"
+#include "ArenaTelemetry.h"
+#include "RobotMemory.h"
+#include "RadarCache.h"
 
-// Cell types
-enum CellType { EMPTY, OBSTACLE_FLAMETHROWER, OBSTACLE_PIT, OBSTACLE_MOUND, ROBOT, DEAD };
+// Settings for a single game
+struct ArenaConfig
+{
+    int rows = 10;
+    int cols = 10;
+    int maxRounds = 10000;
+    unsigned seed = 0;    // 0 picks a seed from the clock
+    bool verbose = true;  // print the board and the turn log
+    std::shared_ptr<LogSink> log; // where a verbose game's log goes, standard output if unset
+    bool sparseGrid = false; // allocate the board in tiles as they're written, for huge mostly empty boards
+    std::shared_ptr<const ObstacleLayout> map; // fixed obstacles for placeObstacles, overrides rows and cols
+    MapStyle mapStyle = MapStyle::Scatter;     // otherwise placeObstacles generates one of these
+    bool symmetricMap = false;
+    std::string checkpointPath; // where snapshots of the game go, see ArenaCheckpoint.h
+    int checkpointEvery = 0;    // rounds between snapshots, 0 for none
+    std::shared_ptr<ArenaTelemetry> telemetry; // heatmap to add this game to, the same size as the board
+    int64_t memoryCap = 0; // heap bytes a robot may hold before it's shut down, 0 for no cap (RobotMemory.h)
+};
 
-struct Cell 
+// Outcome of a finished game. Robots are identified by their load order (slot).
+struct GameResult
 {
-    CellType type = EMPTY;
-    std::string specialChar;
-    RobotBase* robot = nullptr; // Pointer to a robot if the cell contains one
+    std::vector<int> placement;   // slots, winner first
+    std::vector<int> finishRound; // per slot: round the robot died in, -1 if it survived
+    int rounds = 0;
+    bool draw = false;
+    ArenaProfile profile; // all zero unless built with ARENA_PROFILE
+    std::vector<RobotMemoryUse> memory; // per slot: the robot's heap, see RobotMemory.h
 };
 
+class SnapshotWriter;
+
 class Arena 
 {
+    friend class ArenaBench;
+    friend class TestArena;
+
 public:
     Arena(int rows, int cols);
+    explicit Arena(const ArenaConfig& config);
+    // The game coroutine points back at the arena, so an arena stays where it was built
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
 
     void loadRobots(const std::vector<std::string>& robotLibs);
+    void loadRobots(RobotRegistry& registry, const std::vector<int>& robotIds);
+    bool addRobot(std::shared_ptr<RobotLibrary> library);
+    bool addRobot(std::shared_ptr<RobotLibrary> library, const RobotConfig& config); // see RobotConfig.h
+    bool addRobot(RobotBase* robot); // false when the board has no empty cell left, the robot is deleted
     void placeObstacles();
-    void startBattle();
+    void loadObstacles(const ObstacleLayout& layout);
+    GameResult startBattle();
+
+    // The game itself, stopping after every phase of every turn (see GameTask.h), for schedulers
+    // that step games themselves. startBattle drives this same coroutine. Once it's over,
+    // finishBattle gives the result.
+    GameTask& game();
+    GameResult finishBattle();
 
-    ~Arena();
+    // Pick a game back up from a checkpoint instead of placing obstacles and loading robots.
+    // The arena must be empty and the same size as the one that wrote the checkpoint.
+    bool resume(const std::string& path, std::string& error);
 
 private:
     int rows, cols;
-    std::vector<std::vector<Cell>> grid;
-    std::vector<RobotBase*> robots;
-    std::vector<void*> robotHandles;
+    int maxRounds;
+    int64_t memoryCap;
+    std::shared_ptr<LogSink> log; // null for a quiet game
+    uint32_t logSource = 0;
+    std::mt19937 rng;
+    std::shared_ptr<const ObstacleLayout> map;
+    MapStyle mapStyle;
+    bool symmetricMap;
+    ArenaProfile profile;
+    std::shared_ptr<ArenaTelemetry> telemetry; // null unless someone's collecting a heatmap
+    RayCache rays;
+    Grid grid;
+    JumpTables jumps;
+    RadarCache radarCache;
+    RobotTable robots;
+
+    // Game progress, kept here rather than in startBattle so a checkpoint can capture it
+    int round = 0;
+    int stagnationCounter = 0;
+
+    // Scratch space reused every round and turn
+    std::vector<int> prevRows, prevCols, newRows, newCols;
+    std::vector<RadarObj> radarResults;
+
+    std::string checkpointPath;
+    int checkpointEvery;
+    int deltasSinceFull = -1;     // -1 until this game has written a full snapshot
+    std::vector<int64_t> dirtyCells; // row * cols + col of cells changed since the last checkpoint, may repeat
+
+    static ArenaConfig defaultConfig(int rows, int cols);
+
+    // What a robot said it will do this turn, between the decide and resolve phases
+    struct TurnOrders
+    {
+        bool shooting = false;
+        int shotRow = 0, shotCol = 0;
+        int moveDir = 0, moveDist = 0;
+    };
 
     std::vector<char> specialCharacters = { '^', '*', '#', '>', '&', '@', '%', '!', '+'};
-    int get_robot_index(int row, int col) const;
+    char symbolFor(uint32_t slot) const;
+    int randomInt(int low, int high);
+    bool battleOver() const;
+    void logEvent(LogEvent event, std::string_view name = {}, int a = 0, int b = 0, int c = 0) const;
+    void logText(const std::string& text) const;
 
-    RobotBase* loadRobot(const std::string& sharedLib, void*& handle);
-    void placeRobot(RobotBase* robot);
-    void resolveShot(RobotBase* shooter, int targetRow, int targetCol);
-    void moveRobot(RobotBase* robot, int direction, int distance);
+    bool createRobot(std::shared_ptr<RobotLibrary> library, const RobotConfig* config);
+    bool addRobot(RobotBase* robot, std::shared_ptr<RobotLibrary> library, MemoryAccount* account);
+    bool withinMemoryCap(uint32_t slot);
+    bool findEmptyCell(int& row, int& col);
+    void resolveShot(RobotHandle shooter, int targetRow, int targetCol);
+    void fire(int weapon, int shooterRow, int shooterCol, int targetRow, int targetCol);
+    template <WeaponType W>
+    void fireWeapon(int shooterRow, int shooterCol, int targetRow, int targetCol);
+    void moveRobot(RobotHandle handle, int direction, int distance);
+    void setCellType(int row, int col, CellType type);
+    void vacateCell(int row, int col);
+    void occupyCell(int row, int col, RobotHandle handle);
+    void markDirty(int row, int col);
+    void writeCheckpoint();
+    void writeRoundState(SnapshotWriter& writer);
     
-    std::vector<RadarObj> simulateRadar(RobotBase* robot, int radarDir);
+    const std::vector<RadarObj>& simulateRadar(RobotHandle handle, int radarDir);
     std::pair<int, int> getNextCell(int row, int col, int radarDir);
-    void applyDamageToCell(int row, int col, int baseDamage);
+    void applyDamageToCell(int row, int col, int damageMin, int damageMax);
 
     void printArena() const;
     void printHealthBar(RobotBase* robot) const;
     void announceDeath(const RobotBase* robot) const;
-    void simulateTurn(RobotBase* robot);
+    void simulateTurn(RobotHandle handle);
+    void scanRadar(RobotHandle handle);
+    TurnOrders decideTurn(RobotHandle handle);
+    void resolveTurn(RobotHandle handle, const TurnOrders& orders);
+    void beginRound();
+    void endRound(bool progress);
+    GameTask play();
+
+    GameTask gameTask; // last, so the coroutine goes before the state it uses
 };
 
 #endif // ARENA_H
@@ -0,0 +1,453 @@
+#include "Arena.h"
+#include "ArenaCheckpoint.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+
+namespace
+{
+
+// Past this many deltas the next checkpoint rewrites a full snapshot, so resuming stays quick
+constexpr int MAX_DELTAS = 32;
+
+struct RobotRecord
+{
+    int slot = 0;
+    std::string library;
+    std::string name;
+    int health = 0;
+    int armor = 0;
+    int move = 0;
+    int grenades = 0;
+    int row = 0;
+    int col = 0;
+    bool hasState = false;
+    std::string state; // from the library's save_robot_state
+};
+
+// What every record carries besides cells
+struct RoundRecord
+{
+    int round = 0;
+    int stagnationCounter = 0;
+    std::string rng; // std::mt19937 in its stream format
+    std::vector<int> finishRound;
+    std::vector<RobotRecord> robots;
+};
+
+void putCell(SnapshotWriter& writer, const Cell& cell)
+{
+    writer.put<uint8_t>(cell.type);
+    writer.put<uint8_t>(cell.floor);
+    writer.put<uint32_t>(cell.robot.raw());
+}
+
+Cell getCell(SnapshotReader& reader)
+{
+    Cell cell;
+    uint8_t type = reader.get<uint8_t>();
+    uint8_t floor = reader.get<uint8_t>();
+    cell.robot = RobotHandle::fromRaw(reader.get<uint32_t>());
+    cell.type = type <= DEAD ? static_cast<CellType>(type) : EMPTY;
+    cell.floor = floor <= DEAD ? static_cast<CellType>(floor) : EMPTY;
+    return cell;
+}
+
+RoundRecord readRoundState(SnapshotReader& reader)
+{
+    RoundRecord state;
+    state.round = reader.get<int32_t>();
+    state.stagnationCounter = reader.get<int32_t>();
+
+    // The engine state goes in as numbers rather than its text form, about a third of the size
+    uint32_t words = reader.get<uint32_t>();
+    std::ostringstream rng;
+    for (uint32_t i = 0; i < words && reader.ok(); ++i)
+    {
+        rng << reader.get<uint32_t>() << ' ';
+    }
+    state.rng = rng.str();
+
+    uint32_t slots = reader.get<uint32_t>();
+    for (uint32_t i = 0; i < slots && reader.ok(); ++i)
+    {
+        state.finishRound.push_back(reader.get<int32_t>());
+    }
+
+    uint32_t alive = reader.get<uint32_t>();
+    for (uint32_t i = 0; i < alive && reader.ok(); ++i)
+    {
+        RobotRecord robot;
+        robot.slot = reader.get<int32_t>();
+        robot.library = reader.getString();
+        robot.name = reader.getString();
+        robot.health = reader.get<int32_t>();
+        robot.armor = reader.get<int32_t>();
+        robot.move = reader.get<int32_t>();
+        robot.grenades = reader.get<int32_t>();
+        robot.row = reader.get<int32_t>();
+        robot.col = reader.get<int32_t>();
+        robot.hasState = reader.get<uint8_t>() != 0;
+        robot.state = reader.getString();
+        state.robots.push_back(std::move(robot));
+    }
+    return state;
+}
+
+} // namespace
+
+void Arena::writeRoundState(SnapshotWriter& writer)
+{
+    writer.put<int32_t>(round);
+    writer.put<int32_t>(stagnationCounter);
+
+    std::ostringstream text;
+    text << rng;
+    std::istringstream numbers(text.str());
+    std::vector<uint32_t> words;
+    unsigned long word;
+    while (numbers >> word)
+    {
+        words.push_back(static_cast<uint32_t>(word));
+    }
+    writer.put<uint32_t>(static_cast<uint32_t>(words.size()));
+    for (uint32_t w : words)
+    {
+        writer.put<uint32_t>(w);
+    }
+
+    writer.put<uint32_t>(static_cast<uint32_t>(robots.slots()));
+    for (int finished : robots.finishRounds())
+    {
+        writer.put<int32_t>(finished);
+    }
+
+    // In turn order, which resuming keeps
+    writer.put<uint32_t>(static_cast<uint32_t>(robots.livingCount()));
+    for (size_t i = 0; i < robots.livingCount(); ++i)
+    {
+        RobotBase* robot = robots.livingRobot(i);
+        uint32_t slot = robots.livingAt(i).slot();
+        const std::shared_ptr<RobotLibrary>& library = robots.library(slot);
+
+        writer.put<int32_t>(static_cast<int32_t>(slot));
+        writer.putString(library ? library->path() : std::string());
+        writer.putString(robot->m_name);
+        writer.put<int32_t>(robots.health(slot));
+        writer.put<int32_t>(robots.armor(slot));
+        writer.put<int32_t>(robots.moveSpeed(slot));
+        writer.put<int32_t>(robots.grenades(slot));
+        writer.put<int32_t>(robots.row(slot));
+        writer.put<int32_t>(robots.col(slot));
+
+        std::string state;
+        bool hasState = library && library->saveState();
+        if (hasState)
+        {
+            library->saveState()(robot, state);
+        }
+        writer.put<uint8_t>(hasState);
+        writer.putString(state);
+    }
+}
+
+// Append the cells changed since the last checkpoint, or every cell when it's time for a full snapshot
+void Arena::writeCheckpoint()
+{
+    bool full = deltasSinceFull < 0 || deltasSinceFull >= MAX_DELTAS;
+
+    SnapshotWriter payload;
+    writeRoundState(payload);
+    payload.put<int32_t>(rows);
+    payload.put<int32_t>(cols);
+    payload.put<uint8_t>(grid.hasBase());
+
+    // Cells go in as (row * cols + col, cell): for a full snapshot every one that isn't empty,
+    // so a sparse board doesn't write out its empty expanse. On a map's shared obstacles only the
+    // tiles this arena has written are looked at, the rest come back from the map on resume.
+    std::vector<int64_t> cells;
+    if (full)
+    {
+        grid.forEachAllocated([&](int row, int col, const Cell& cell)
+        {
+            if (cell.type != EMPTY || cell.floor != EMPTY || cell.robot)
+            {
+                cells.push_back(static_cast<int64_t>(row) * cols + col);
+            }
+        });
+    }
+    else
+    {
+        std::sort(dirtyCells.begin(), dirtyCells.end());
+        dirtyCells.erase(std::unique(dirtyCells.begin(), dirtyCells.end()), dirtyCells.end());
+        cells.swap(dirtyCells);
+    }
+    payload.put<uint64_t>(cells.size());
+    for (int64_t index : cells)
+    {
+        payload.put<int64_t>(index);
+        putCell(payload, grid.at(static_cast<int>(index / cols), static_cast<int>(index % cols)));
+    }
+
+    SnapshotWriter record;
+    for (char c : checkpointMagic)
+    {
+        record.put<char>(c);
+    }
+    record.put<char>(full ? checkpointFull : checkpointDelta);
+    record.putString(payload.data());
+
+    // A full snapshot replaces the file in one rename, so there is always a usable checkpoint on disk
+    std::string target = full ? checkpointPath + ".tmp" : checkpointPath;
+    std::ofstream file(target, std::ios::binary | (full ? std::ios::trunc : std::ios::app));
+    file.write(record.data().data(), record.data().size());
+    file.close();
+    bool written = !file.fail() && (!full || std::rename(target.c_str(), checkpointPath.c_str()) == 0);
+
+    if (!written)
+    {
+        // A half written delta would hide everything appended after it, start over with a full one
+        std::cerr << "Failed to write checkpoint " << checkpointPath << "\n";
+        deltasSinceFull = -1;
+        dirtyCells.clear();
+        return;
+    }
+
+    deltasSinceFull = full ? 0 : deltasSinceFull + 1;
+    dirtyCells.clear();
+}
+
+bool Arena::resume(const std::string& path, std::string& error)
+{
+    if (robots.slots() != 0)
+    {
+        error = "the arena already has robots";
+        return false;
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    // Replay the records. Anything after the first bad or truncated one is ignored.
+    Grid cells = grid.blankCopy();
+    RoundRecord state;
+    int records = 0;
+    int deltas = 0;
+    bool torn = false;
+    SnapshotReader file(bytes.data(), bytes.data() + bytes.size());
+    while (!file.done())
+    {
+        char magic[sizeof(checkpointMagic)];
+        for (char& c : magic)
+        {
+            c = file.get<char>();
+        }
+        char kind = file.get<char>();
+        std::string payload = file.getString();
+        if (!file.ok() || std::memcmp(magic, checkpointMagic, sizeof(magic)) != 0
+            || (kind != checkpointFull && kind != checkpointDelta) || (records == 0 && kind != checkpointFull))
+        {
+            torn = true;
+            break;
+        }
+
+        SnapshotReader reader(payload.data(), payload.data() + payload.size());
+        RoundRecord next = readRoundState(reader);
+        int snapshotRows = reader.get<int32_t>();
+        int snapshotCols = reader.get<int32_t>();
+        bool onMap = reader.get<uint8_t>();
+        if (reader.ok() && (snapshotRows != rows || snapshotCols != cols))
+        {
+            error = path + " is for a " + std::to_string(snapshotRows) + "x" + std::to_string(snapshotCols) + " arena";
+            return false;
+        }
+        if (reader.ok() && onMap != grid.hasBase())
+        {
+            error = onMap ? path + " was written on a map, resume it with the same map" : path + " was not written on a map";
+            return false;
+        }
+
+        std::vector<std::pair<int64_t, Cell>> changed;
+        uint64_t count = reader.get<uint64_t>();
+        for (uint64_t i = 0; i < count && reader.ok(); ++i)
+        {
+            int64_t index = reader.get<int64_t>();
+            Cell cell = getCell(reader);
+            if (index >= 0 && index < static_cast<int64_t>(rows) * cols)
+            {
+                changed.emplace_back(index, cell);
+            }
+        }
+        if (!reader.ok() || !reader.done())
+        {
+            torn = true;
+            break;
+        }
+
+        if (kind == checkpointFull)
+        {
+            cells.clear();
+        }
+        for (const auto& [index, cell] : changed)
+        {
+            cells.edit(static_cast<int>(index / cols), static_cast<int>(index % cols)) = cell;
+        }
+        state = std::move(next);
+        deltas = kind == checkpointFull ? 0 : deltas + 1;
+        ++records;
+    }
+
+    if (records == 0)
+    {
+        error = path + " has no complete snapshot";
+        return false;
+    }
+
+    // Robots come back fresh from their libraries and get wound forward with the same mutators
+    // the game uses on them, so nothing here needs to reach into RobotBase.
+    std::map<std::string, std::shared_ptr<RobotLibrary>> libraries;
+    struct Restored
+    {
+        RobotBase* robot;
+        std::shared_ptr<RobotLibrary> library;
+        MemoryAccount* account;
+    };
+    std::vector<Restored> restored;
+    auto fail = [&](const std::string& why)
+    {
+        for (Restored& entry : restored)
+        {
+            {
+                MemoryScope charge(entry.account);
+                delete entry.robot;
+            }
+            closeMemoryAccount(entry.account);
+        }
+        error = why;
+        return false;
+    };
+
+    std::vector<bool> seen(state.finishRound.size(), false);
+    for (const RobotRecord& record : state.robots)
+    {
+        if (record.library.empty())
+        {
+            return fail(record.name + " was not loaded from a library and cannot be restored");
+        }
+        if (record.slot < 0 || record.slot >= static_cast<int>(state.finishRound.size())
+            || state.finishRound[record.slot] >= 0 || seen[record.slot]
+            || record.row < 0 || record.row >= rows || record.col < 0 || record.col >= cols
+            || cells.at(record.row, record.col).type != ROBOT)
+        {
+            return fail(path + " is inconsistent");
+        }
+        seen[record.slot] = true;
+
+        std::shared_ptr<RobotLibrary>& library = libraries[record.library];
+        if (!library && !(library = RobotLibrary::open(record.library, error)))
+        {
+            return fail(record.library + ": " + error);
+        }
+
+        // Charged to the robot from its constructor on, as in a fresh game
+        MemoryAccount* account = openMemoryAccount(memoryCap);
+        RobotBase* robot;
+        {
+            MemoryScope charge(account);
+            robot = library->create();
+        }
+        if (!robot)
+        {
+            closeMemoryAccount(account);
+            return fail(record.library + ": create_robot returned null");
+        }
+        restored.push_back(Restored{robot, library, account});
+
+        if (record.health > robot->get_health() || record.armor > robot->get_armor()
+            || (record.move != 0 && record.move != robot->get_move_speed()) || record.grenades > robot->get_grenades())
+        {
+            return fail(record.library + " no longer builds the robot in the checkpoint");
+        }
+        robot->take_damage(robot->get_health() - record.health);
+        robot->reduce_armor(robot->get_armor() - record.armor);
+        if (record.move == 0)
+        {
+            robot->disable_movement();
+        }
+        while (robot->get_grenades() > record.grenades)
+        {
+            robot->decrement_grenades();
+        }
+        robot->move_to(record.row, record.col);
+        robot->m_name = record.name;
+
+        bool loaded = true;
+        if (record.hasState && library->loadState())
+        {
+            MemoryScope charge(account);
+            loaded = library->loadState()(robot, record.state);
+        }
+        if (!loaded)
+        {
+            return fail(record.name + " could not load its saved state");
+        }
+    }
+
+    // Every robot and wreck on the board has to name a slot the table will have
+    bool handlesOk = true;
+    cells.forEachAllocated([&](int, int, const Cell& cell)
+    {
+        if ((cell.type == ROBOT || cell.type == DEAD)
+            && (!cell.robot || cell.robot.slot() >= state.finishRound.size()))
+        {
+            handlesOk = false;
+        }
+    });
+    if (!handlesOk)
+    {
+        return fail(path + " is inconsistent");
+    }
+
+    std::istringstream rngState(state.rng);
+    std::mt19937 restoredRng;
+    if (!(rngState >> restoredRng))
+    {
+        return fail(path + " has a bad random number generator state");
+    }
+
+    // Everything checked out, swap it all in
+    grid = std::move(cells);
+    jumps.build();
+    radarCache.clear();
+    rng = restoredRng;
+    round = state.round;
+    stagnationCounter = state.stagnationCounter;
+    std::vector<char> symbols;
+    for (size_t slot = 0; slot < state.finishRound.size(); ++slot)
+    {
+        symbols.push_back(symbolFor(static_cast<uint32_t>(slot)));
+    }
+    robots.restore(state.finishRound, symbols);
+    for (size_t i = 0; i < restored.size(); ++i)
+    {
+        const RobotRecord& record = state.robots[i];
+        grid.edit(record.row, record.col).robot = robots.put(record.slot, restored[i].robot, std::move(restored[i].library),
+                                                            restored[i].account);
+    }
+
+    // Deltas can go on being appended if the file we'll write to ends exactly at this state
+    deltasSinceFull = path == checkpointPath && !torn ? deltas : -1;
+    dirtyCells.clear();
+
+    logText("Resumed " + path + " at round " + std::to_string(round) + " with " + std::to_string(robots.livingCount())
+            + " robots\n");
+    return true;
+}
@@ -0,0 +1,94 @@
+#ifndef ARENA_CHECKPOINT_H
+#define ARENA_CHECKPOINT_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+// Binary checkpoints of a running game (Arena::writeCheckpoint / Arena::resume).
+//
+// A checkpoint file is one full snapshot followed by any number of deltas, each a record:
+//   "RWCK"  kind ('F' full, 'D' delta)  uint32 payload size  payload
+// Both kinds carry the round counters, RNG state and every live robot. A full snapshot then has
+// every cell that isn't empty (for an arena on a map, every one in a tile it has written; the
+// rest is the map's), a delta only the cells that changed since the record before it.
+// Resuming replays the records in order; a record cut short by a crash is ignored, so the game
+// picks up from the one before it. Values are written in host byte order, checkpoints are not meant to travel.
+
+constexpr char checkpointMagic[4] = { 'R', 'W', 'C', 'K' };
+constexpr char checkpointFull = 'F';
+constexpr char checkpointDelta = 'D';
+
+class SnapshotWriter
+{
+public:
+    template <typename T>
+    void put(T value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        bytes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void putString(const std::string& s)
+    {
+        put(static_cast<uint32_t>(s.size()));
+        bytes += s;
+    }
+
+    const std::string& data() const { return bytes; }
+
+private:
+    std::string bytes;
+};
+
+// Reads until it runs out, after which ok() is false and everything reads as zero
+class SnapshotReader
+{
+public:
+    SnapshotReader(const char* begin, const char* end) : pos(begin), end(end) {}
+
+    template <typename T>
+    T get()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value{};
+        if (!take(sizeof(value)))
+        {
+            return value;
+        }
+        std::memcpy(&value, pos - sizeof(value), sizeof(value));
+        return value;
+    }
+
+    std::string getString()
+    {
+        uint32_t size = get<uint32_t>();
+        if (!take(size))
+        {
+            return {};
+        }
+        return std::string(pos - size, size);
+    }
+
+    bool ok() const { return good; }
+    bool done() const { return pos == end; }
+
+private:
+    bool take(size_t size)
+    {
+        if (!good || static_cast<size_t>(end - pos) < size)
+        {
+            good = false;
+            return false;
+        }
+        pos += size;
+        return true;
+    }
+
+    const char* pos;
+    const char* end;
+    bool good = true;
+};
+
+#endif // ARENA_CHECKPOINT_H
@@ -0,0 +1,67 @@
+#include "ArenaProfile.h"
+#include <iomanip>
+
+static const char* phaseNames[PHASE_COUNT] =
+{
+    "radar scan",
+    "robot get_radar_direction",
+    "robot process_radar_results",
+    "robot get_shot_location",
+    "robot get_move_direction",
+    "shot: flamethrower",
+    "shot: railgun",
+    "shot: grenade",
+    "shot: hammer",
+    "movement",
+    "rendering",
+    "death cleanup",
+    "checkpoint"
+};
+
+void ArenaProfile::merge(const ArenaProfile& other)
+{
+    for (int i = 0; i < PHASE_COUNT; ++i)
+    {
+        phases[i].nanos += other.phases[i].nanos;
+        phases[i].calls += other.phases[i].calls;
+    }
+    radarCache.hits += other.radarCache.hits;
+    radarCache.misses += other.radarCache.misses;
+    radarCache.invalidations += other.radarCache.invalidations;
+}
+
+void ArenaProfile::print(std::ostream& os, const char* title) const
+{
+    uint64_t total = 0;
+    for (const PhaseCounter& phase : phases)
+    {
+        total += phase.nanos;
+    }
+
+    os << "\n=========== " << title << " ===========\n";
+    os << std::left << std::setw(30) << "phase" << std::right << std::setw(12) << "calls"
+       << std::setw(14) << "total ms" << std::setw(12) << "ns/call" << std::setw(8) << "%" << "\n";
+
+    for (int i = 0; i < PHASE_COUNT; ++i)
+    {
+        const PhaseCounter& phase = phases[i];
+        if (phase.calls == 0)
+        {
+            continue;
+        }
+        os << std::left << std::setw(30) << phaseNames[i] << std::right
+           << std::setw(12) << phase.calls
+           << std::setw(14) << std::fixed << std::setprecision(3) << phase.nanos / 1e6
+           << std::setw(12) << phase.nanos / phase.calls
+           << std::setw(8) << std::setprecision(1) << (total ? 100.0 * phase.nanos / total : 0.0) << "\n";
+    }
+
+    uint64_t scans = radarCache.hits + radarCache.misses;
+    if (scans > 0)
+    {
+        os << "radar cache: " << radarCache.hits << " hits, " << radarCache.misses << " misses ("
+           << std::fixed << std::setprecision(1) << 100.0 * radarCache.hits / scans << "% hit), "
+           << radarCache.invalidations << " rays invalidated\n";
+    }
+    os << std::defaultfloat;
+}
@@ -0,0 +1,90 @@
+#ifndef ARENA_PROFILE_H
+#define ARENA_PROFILE_H
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+// Where a game spends its time. Build with `make PROFILE=1` (defines ARENA_PROFILE) to turn the
+// counters on; without it PROFILE_SCOPE expands to nothing and the game loop is unchanged.
+enum ProfilePhase
+{
+    PHASE_RADAR,
+    PHASE_ROBOT_RADAR_DIRECTION,
+    PHASE_ROBOT_PROCESS_RADAR,
+    PHASE_ROBOT_SHOT_LOCATION,
+    PHASE_ROBOT_MOVE_DIRECTION,
+    PHASE_SHOT_FLAMETHROWER, // shot phases are in WeaponType order
+    PHASE_SHOT_RAILGUN,
+    PHASE_SHOT_GRENADE,
+    PHASE_SHOT_HAMMER,
+    PHASE_MOVE,
+    PHASE_RENDER,
+    PHASE_DEATH_CLEANUP,
+    PHASE_CHECKPOINT,
+    PHASE_COUNT
+};
+
+struct PhaseCounter
+{
+    uint64_t nanos = 0;
+    uint64_t calls = 0;
+};
+
+// How often Arena::simulateRadar was answered from the RadarCache
+struct CacheCounter
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t invalidations = 0; // cached rays thrown away because a cell on them changed
+};
+
+struct ArenaProfile
+{
+    PhaseCounter phases[PHASE_COUNT];
+    CacheCounter radarCache;
+
+    void merge(const ArenaProfile& other);
+    void print(std::ostream& os, const char* title) const;
+};
+
+#ifdef ARENA_PROFILE
+
+constexpr bool profilingEnabled = true;
+
+// Adds the time between construction and destruction to a counter
+class ProfileScope
+{
+public:
+    explicit ProfileScope(PhaseCounter& counter)
+    : counter(counter), start(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~ProfileScope()
+    {
+        counter.nanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - start).count();
+        ++counter.calls;
+    }
+
+private:
+    PhaseCounter& counter;
+    std::chrono::steady_clock::time_point start;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(profile, phase) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)((profile).phases[phase])
+#define PROFILE_COUNT(counter, amount) ((counter) += (amount))
+
+#else
+
+constexpr bool profilingEnabled = false;
+
+#define PROFILE_SCOPE(profile, phase) ((void)0)
+#define PROFILE_COUNT(counter, amount) ((void)0)
+
+#endif // ARENA_PROFILE
+
+#endif // ARENA_PROFILE_H
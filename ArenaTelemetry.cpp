@@ -0,0 +1,90 @@
+#include "ArenaTelemetry.h"
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+
+constexpr char heatmapMagic[8] = { 'R', 'W', 'H', 'E', 'A', 'T', 0, 0 };
+
+struct HeatmapHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t counters;
+    int32_t rows;
+    int32_t cols;
+    uint64_t games;
+};
+
+bool endsWith(const std::string& s, const std::string& suffix)
+{
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace
+
+ArenaTelemetry::ArenaTelemetry(int rows, int cols)
+: numRows(rows), numCols(cols),
+  counts(new std::atomic<uint64_t>[static_cast<size_t>(TELEMETRY_COUNTER_COUNT) * rows * cols]())
+{
+}
+
+bool ArenaTelemetry::save(const std::string& path, std::string& error) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (endsWith(path, ".csv"))
+    {
+        file << "row,col,visits,damage,deaths,flames,pits,blocks\n";
+        for (int row = 0; row < numRows; ++row)
+        {
+            for (int col = 0; col < numCols; ++col)
+            {
+                uint64_t values[TELEMETRY_COUNTER_COUNT];
+                bool any = false;
+                for (int c = 0; c < TELEMETRY_COUNTER_COUNT; ++c)
+                {
+                    values[c] = get(static_cast<TelemetryCounter>(c), row, col);
+                    any |= values[c] != 0;
+                }
+                if (!any)
+                {
+                    continue;
+                }
+                file << row << ',' << col;
+                for (uint64_t value : values)
+                {
+                    file << ',' << value;
+                }
+                file << '\n';
+            }
+        }
+    }
+    else
+    {
+        HeatmapHeader header{};
+        std::memcpy(header.magic, heatmapMagic, sizeof(heatmapMagic));
+        header.version = VERSION;
+        header.counters = TELEMETRY_COUNTER_COUNT;
+        header.rows = numRows;
+        header.cols = numCols;
+        header.games = gameCount();
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        size_t total = static_cast<size_t>(TELEMETRY_COUNTER_COUNT) * numRows * numCols;
+        std::vector<uint64_t> plain(total);
+        for (size_t i = 0; i < total; ++i)
+        {
+            plain[i] = counts[i].load(std::memory_order_relaxed);
+        }
+        file.write(reinterpret_cast<const char*>(plain.data()), static_cast<std::streamsize>(total * sizeof(uint64_t)));
+    }
+    file.close();
+    if (file.fail())
+    {
+        error = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
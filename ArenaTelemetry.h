@@ -0,0 +1,72 @@
+#ifndef ARENA_TELEMETRY_H
+#define ARENA_TELEMETRY_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// What happens on each cell, summed over every game sharing one ArenaTelemetry
+enum TelemetryCounter
+{
+    TELEMETRY_VISITS, // moves that ended here
+    TELEMETRY_DAMAGE, // health robots here lost to shots and flamethrowers (not the damage rolled)
+    TELEMETRY_DEATHS, // robots that died here
+    TELEMETRY_FLAMES, // flamethrowers set off (the flamethrower's cell)
+    TELEMETRY_PITS,   // robots that fell in (the pit's cell)
+    TELEMETRY_BLOCKS, // moves cut short by what's here: mound, wreck or robot
+    TELEMETRY_COUNTER_COUNT
+};
+
+// A heatmap of where fights happen and what gets in the way, for a tournament's worth of games on
+// boards the same size. Games on any number of threads add to the same counters with relaxed
+// atomic adds: nothing reads them until the games are done, and an add is one uncontended
+// instruction next to the move or shot that caused it. Arenas without one pay a null check.
+//
+// Heatmap file, version 1, host byte order:
+//   char[8]  "RWHEAT\0\0"
+//   uint32   version (1)
+//   uint32   counters (TELEMETRY_COUNTER_COUNT)
+//   int32    rows
+//   int32    cols
+//   uint64   games
+//   uint64   counts, counter by counter, each row-major
+// or as CSV, one line per cell with anything on it: row,col,visits,damage,deaths,flames,pits,blocks
+class ArenaTelemetry
+{
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    ArenaTelemetry(int rows, int cols);
+
+    int rows() const { return numRows; }
+    int cols() const { return numCols; }
+
+    void add(TelemetryCounter counter, int row, int col, uint64_t amount = 1)
+    {
+        counts[index(counter, row, col)].fetch_add(amount, std::memory_order_relaxed);
+    }
+    void addGame() { games.fetch_add(1, std::memory_order_relaxed); }
+
+    uint64_t get(TelemetryCounter counter, int row, int col) const
+    {
+        return counts[index(counter, row, col)].load(std::memory_order_relaxed);
+    }
+    uint64_t gameCount() const { return games.load(std::memory_order_relaxed); }
+
+    // CSV if the path ends in .csv, the binary heatmap otherwise
+    bool save(const std::string& path, std::string& error) const;
+
+private:
+    int numRows;
+    int numCols;
+    std::unique_ptr<std::atomic<uint64_t>[]> counts;
+    std::atomic<uint64_t> games{0};
+
+    size_t index(TelemetryCounter counter, int row, int col) const
+    {
+        return (static_cast<size_t>(counter) * numRows + row) * numCols + col;
+    }
+};
+
+#endif // ARENA_TELEMETRY_H
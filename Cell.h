@@ -0,0 +1,49 @@
+#ifndef CELL_H
+#define CELL_H
+
+#include <cstdint>
+#include "RobotBase.h"
+
+// Cell types
+enum CellType : uint8_t { EMPTY, OBSTACLE_FLAMETHROWER, OBSTACLE_PIT, OBSTACLE_MOUND, ROBOT, DEAD };
+
+// Which robot a cell refers to: its slot in the arena's RobotTable and the generation of that
+// slot when the handle was made. Once the robot is removed the slot's generation moves on, so a
+// handle left behind (in a wreck, say) still names the slot but no longer finds a robot.
+class RobotHandle
+{
+public:
+    static constexpr int SLOT_BITS = 24;
+    static constexpr uint32_t SLOT_MASK = (1u << SLOT_BITS) - 1;
+    static constexpr uint32_t MAX_SLOTS = SLOT_MASK; // the all ones slot is left for "no robot"
+
+    RobotHandle() = default;
+    RobotHandle(uint32_t slot, uint32_t generation) : bits(slot | generation << SLOT_BITS) {}
+
+    uint32_t slot() const { return bits & SLOT_MASK; }
+    uint32_t generation() const { return bits >> SLOT_BITS; }
+    explicit operator bool() const { return bits != NONE; }
+
+    // Packed form, for checkpoints
+    uint32_t raw() const { return bits; }
+    static RobotHandle fromRaw(uint32_t raw) { RobotHandle handle; handle.bits = raw; return handle; }
+
+private:
+    static constexpr uint32_t NONE = ~0u;
+    uint32_t bits = NONE;
+};
+
+struct Cell 
+{
+    CellType type = EMPTY;
+    CellType floor = EMPTY; // the pit or flamethrower under a robot standing on one
+    RobotHandle robot;      // the robot standing here, or the one a wreck was
+};
+
+// Mounds, robots and wrecks: movement stops in front of them, radar and most shots stop at them
+inline bool isBlocker(CellType type)
+{
+    return type == OBSTACLE_MOUND || type == ROBOT || type == DEAD;
+}
+
+#endif // CELL_H
@@ -0,0 +1,101 @@
+#ifndef GAME_TASK_H
+#define GAME_TASK_H
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+// The last thing a suspended game finished
+enum class GamePhase
+{
+    Start,       // nothing yet
+    Radar,       // a robot picked a radar direction and was shown what it sees
+    Decide,      // the robot said where it shoots or moves
+    Resolve,     // the shot or move was carried out, the robot's turn is over
+    Bookkeeping, // the round is over: progress checked, the dead cleared away, checkpoint written
+    Over,        // the game is over, Arena::finishBattle gives the result
+};
+
+// A game as a C++20 coroutine (Arena::game). It suspends after every phase of every turn and
+// only runs when resumed, so whoever holds it decides when the game moves on and on which
+// thread: interleave many games on a few threads, stop one at a round boundary to checkpoint it,
+// or step it a phase at a time for a spectator.
+//
+// One thread resumes a game at a time. The arena must be left alone while its game is suspended
+// mid-round; the board and robot table are only in a consistent state at Start and Bookkeeping.
+class GameTask
+{
+public:
+    struct promise_type
+    {
+        GamePhase phase = GamePhase::Start;
+        std::exception_ptr error;
+
+        GameTask get_return_object() { return GameTask(Handle::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(GamePhase finished) noexcept
+        {
+            phase = finished;
+            return {};
+        }
+        void return_void() { phase = GamePhase::Over; }
+        void unhandled_exception()
+        {
+            error = std::current_exception();
+            phase = GamePhase::Over;
+        }
+    };
+    using Handle = std::coroutine_handle<promise_type>;
+
+    GameTask() = default;
+    GameTask(GameTask&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    GameTask& operator=(GameTask&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle)
+            {
+                handle.destroy();
+            }
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    GameTask(const GameTask&) = delete;
+    GameTask& operator=(const GameTask&) = delete;
+    ~GameTask()
+    {
+        if (handle)
+        {
+            handle.destroy();
+        }
+    }
+
+    // Play the game up to the end of its next phase. Returns false, without playing anything,
+    // once the game is over. Anything a robot throws comes out of here.
+    bool resume()
+    {
+        if (!handle || handle.done())
+        {
+            return false;
+        }
+        handle.resume();
+        if (handle.promise().error)
+        {
+            std::rethrow_exception(std::exchange(handle.promise().error, nullptr));
+        }
+        return !handle.done();
+    }
+
+    GamePhase phase() const { return handle ? handle.promise().phase : GamePhase::Start; }
+    bool valid() const { return static_cast<bool>(handle); }
+    bool done() const { return handle && handle.done(); }
+
+private:
+    explicit GameTask(Handle handle) : handle(handle) {}
+
+    Handle handle;
+};
+
+#endif // GAME_TASK_H
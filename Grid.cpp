@@ -0,0 +1,91 @@
+#include "Grid.h"
+#include <map>
+#include <mutex>
+
+const Grid::Tile Grid::emptyTile{};
+
+Grid::Grid(int rows, int cols, bool sparse)
+: numRows(rows), numCols(cols), isSparse(sparse),
+  tileCols((static_cast<size_t>(cols) + TILE_MASK) >> TILE_SHIFT)
+{
+    size_t tiles = ((static_cast<size_t>(rows) + TILE_MASK) >> TILE_SHIFT) * tileCols;
+    view.assign(tiles, &emptyTile);
+    owned.resize(tiles);
+    clear();
+}
+
+Grid::Grid(std::shared_ptr<const Grid> base)
+: numRows(base->numRows), numCols(base->numCols), isSparse(true), tileCols(base->tileCols),
+  base(std::move(base)), view(this->base->view), owned(view.size())
+{
+}
+
+std::shared_ptr<const Grid> Grid::shared(const std::shared_ptr<const ObstacleLayout>& layout)
+{
+    static std::mutex mutex;
+    static std::map<const ObstacleLayout*, std::weak_ptr<const Grid>> built;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<const Grid> existing = built[layout.get()].lock();
+    if (existing)
+    {
+        return existing;
+    }
+
+    for (auto it = built.begin(); it != built.end(); )
+    {
+        it = it->second.expired() ? built.erase(it) : std::next(it);
+    }
+
+    auto grid = std::make_shared<Grid>(layout->rows(), layout->cols(), true);
+    grid->source = layout;
+    for (int r = 0; r < layout->rows(); ++r)
+    {
+        for (int c = 0; c < layout->cols(); ++c)
+        {
+            CellType type = layout->at(r, c);
+            if (type != EMPTY)
+            {
+                grid->edit(r, c).type = type;
+            }
+        }
+    }
+    built[layout.get()] = grid;
+    return grid;
+}
+
+Grid Grid::blankCopy() const
+{
+    return base ? Grid(base) : Grid(numRows, numCols, isSparse);
+}
+
+void Grid::allocate(size_t tile)
+{
+    owned[tile] = std::make_unique<Tile>(*view[tile]);
+    view[tile] = owned[tile].get();
+    ++allocated;
+}
+
+void Grid::clear()
+{
+    for (size_t tile = 0; tile < owned.size(); ++tile)
+    {
+        if (isSparse)
+        {
+            owned[tile].reset();
+            view[tile] = base ? base->view[tile] : &emptyTile;
+        }
+        else if (!owned[tile])
+        {
+            allocate(tile);
+        }
+        else
+        {
+            *owned[tile] = Tile{};
+        }
+    }
+    if (isSparse)
+    {
+        allocated = 0;
+    }
+}
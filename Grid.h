@@ -0,0 +1,129 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Cell.h"
+#include "ObstacleLayout.h"
+
+// The arena's cells, stored as 64x64 tiles behind a directory.
+//
+// A dense grid allocates every tile up front. A sparse grid starts with every directory entry
+// pointing at one shared, read-only empty tile and only allocates a tile when one of its cells
+// is written, so a huge board that is mostly empty costs memory for the parts that aren't.
+// Reads look the same either way and never branch on it: at() goes through the directory.
+//
+// A grid can also be built on a base: a read-only grid holding a map's obstacles, shared by
+// every arena playing that map (see shared()). Its directory starts out pointing at the base's
+// tiles and a tile is copied the first time one of its cells is written, so each arena only pays
+// for the tiles its robots have been through. Such a grid counts as sparse.
+class Grid
+{
+public:
+    static constexpr int TILE_SHIFT = 6;
+    static constexpr int TILE_SIZE = 1 << TILE_SHIFT;
+    static constexpr int TILE_MASK = TILE_SIZE - 1;
+
+    Grid(int rows, int cols, bool sparse);
+    explicit Grid(std::shared_ptr<const Grid> base);
+
+    Grid(Grid&&) = default;
+    Grid& operator=(Grid&&) = default;
+
+    // The obstacles of a layout as a base grid. Arenas asking for the same layout while one
+    // built from it is still alive get that one back, so it is decoded once however many play it.
+    static std::shared_ptr<const Grid> shared(const std::shared_ptr<const ObstacleLayout>& layout);
+
+    // A grid of the same size and kind with nothing written, sharing the same base if any
+    Grid blankCopy() const;
+
+    int rows() const { return numRows; }
+    int cols() const { return numCols; }
+    bool sparse() const { return isSparse; }
+    bool hasBase() const { return base != nullptr; }
+
+    const Cell& at(int row, int col) const
+    {
+        return view[tileIndex(row, col)]->cells[cellIndex(row, col)];
+    }
+
+    // For writing, allocates the tile on a sparse grid (a copy of the base's, if there is one)
+    Cell& edit(int row, int col)
+    {
+        size_t tile = tileIndex(row, col);
+        if (!owned[tile])
+        {
+            allocate(tile);
+        }
+        return owned[tile]->cells[cellIndex(row, col)];
+    }
+
+    // Back to all empty (or to the base), giving the tiles of a sparse grid back
+    void clear();
+
+    // Visit (row, col, cell) for every cell in an allocated tile, in row order within each tile.
+    // On a sparse grid every cell that was never written is skipped: it is empty, or as in the base.
+    template <typename Visit>
+    void forEachAllocated(Visit visit) const
+    {
+        for (size_t tile = 0; tile < owned.size(); ++tile)
+        {
+            if (!owned[tile])
+            {
+                continue;
+            }
+            int top = static_cast<int>(tile / tileCols) << TILE_SHIFT;
+            int left = static_cast<int>(tile % tileCols) << TILE_SHIFT;
+            for (int r = top; r < std::min(top + TILE_SIZE, numRows); ++r)
+            {
+                for (int c = left; c < std::min(left + TILE_SIZE, numCols); ++c)
+                {
+                    visit(r, c, at(r, c));
+                }
+            }
+        }
+    }
+
+    size_t allocatedTiles() const { return allocated; }
+    size_t tileBytes() const { return sizeof(Tile); }
+
+    // What this grid holds on its own: the directory and its allocated tiles, not the base
+    size_t bytes() const
+    {
+        return view.size() * (sizeof(view[0]) + sizeof(owned[0])) + allocated * sizeof(Tile);
+    }
+
+private:
+    struct Tile
+    {
+        Cell cells[TILE_SIZE * TILE_SIZE];
+    };
+
+    size_t tileIndex(int row, int col) const
+    {
+        return static_cast<size_t>(row >> TILE_SHIFT) * tileCols + (col >> TILE_SHIFT);
+    }
+
+    static int cellIndex(int row, int col)
+    {
+        return ((row & TILE_MASK) << TILE_SHIFT) | (col & TILE_MASK);
+    }
+
+    void allocate(size_t tile);
+
+    static const Tile emptyTile;
+
+    int numRows;
+    int numCols;
+    bool isSparse;
+    size_t tileCols;
+    size_t allocated = 0;
+    std::shared_ptr<const Grid> base;
+    std::shared_ptr<const ObstacleLayout> source; // kept alive by a base so shared() can key on its address
+    std::vector<const Tile*> view;            // what reads go through, &emptyTile until written
+    std::vector<std::unique_ptr<Tile>> owned;
+};
+
+#endif // GRID_H
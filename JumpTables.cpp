@@ -0,0 +1,102 @@
+#include "JumpTables.h"
+#include <algorithm>
+
+JumpTables::JumpTables(const Grid& grid)
+: grid(grid), rows(grid.rows()), cols(grid.cols()),
+  tabulated(!grid.sparse() && static_cast<long long>(rows) * cols > SMALL_BOARD_CELLS),
+  free(tabulated ? 8 * static_cast<size_t>(rows) * cols : 0), pit(free.size()), flame(free.size())
+{
+    build();
+}
+
+bool JumpTables::update(int direction, int row, int col)
+{
+    int nextRow = row + directions[direction].first;
+    int nextCol = col + directions[direction].second;
+
+    uint8_t newFree = 0, newPit = LIMIT, newFlame = LIMIT;
+    if (nextRow >= 0 && nextRow < rows && nextCol >= 0 && nextCol < cols)
+    {
+        CellType next = grid.at(nextRow, nextCol).type;
+        size_t n = index(direction, nextRow, nextCol);
+        newFree = isBlocker(next) ? 0 : std::min(LIMIT, free[n] + 1);
+        newPit = next == OBSTACLE_PIT ? 1 : std::min(LIMIT, pit[n] + 1);
+        newFlame = next == OBSTACLE_FLAMETHROWER ? 1 : std::min(LIMIT, flame[n] + 1);
+    }
+
+    size_t i = index(direction, row, col);
+    bool changed = free[i] != newFree || pit[i] != newPit || flame[i] != newFlame;
+    free[i] = newFree;
+    pit[i] = newPit;
+    flame[i] = newFlame;
+    return changed;
+}
+
+void JumpTables::build()
+{
+    if (!tabulated)
+    {
+        return;
+    }
+
+    for (int direction = 1; direction <= 8; ++direction)
+    {
+        // Visit cells so that the neighbour in this direction is always done first
+        int dRow = directions[direction].first;
+        int dCol = directions[direction].second;
+        for (int i = 0; i < rows; ++i)
+        {
+            int row = dRow > 0 ? rows - 1 - i : i;
+            for (int j = 0; j < cols; ++j)
+            {
+                int col = dCol > 0 ? cols - 1 - j : j;
+                update(direction, row, col);
+            }
+        }
+    }
+}
+
+void JumpTables::cellChanged(int row, int col)
+{
+    if (!tabulated)
+    {
+        return;
+    }
+
+    for (int direction = 1; direction <= 8; ++direction)
+    {
+        // Walk back against the direction until the values stop changing
+        int dRow = directions[direction].first;
+        int dCol = directions[direction].second;
+        int r = row - dRow;
+        int c = col - dCol;
+        while (r >= 0 && r < rows && c >= 0 && c < cols && update(direction, r, c))
+        {
+            r -= dRow;
+            c -= dCol;
+        }
+    }
+}
+
+int JumpTables::scan(int direction, int row, int col, Lookup lookup) const
+{
+    int dRow = directions[direction].first;
+    int dCol = directions[direction].second;
+    for (int step = 1; step <= LIMIT; ++step)
+    {
+        int r = row + step * dRow;
+        int c = col + step * dCol;
+        if (r < 0 || r >= rows || c < 0 || c >= cols)
+        {
+            return lookup == FREE ? step - 1 : LIMIT;
+        }
+
+        CellType type = grid.at(r, c).type;
+        if ((lookup == FREE && isBlocker(type)) || (lookup == PIT && type == OBSTACLE_PIT)
+            || (lookup == FLAME && type == OBSTACLE_FLAMETHROWER))
+        {
+            return lookup == FREE ? step - 1 : step;
+        }
+    }
+    return LIMIT;
+}
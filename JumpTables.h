@@ -0,0 +1,74 @@
+#ifndef JUMP_TABLES_H
+#define JUMP_TABLES_H
+
+#include <cstdint>
+#include <vector>
+#include "Grid.h"
+
+// Lookups that let Arena::moveRobot resolve a whole move at once instead of walking it cell by cell.
+// For every cell and each of the 8 directions they hold:
+//   free  - steps that can be taken before a blocker (mound, robot, wreck) or the edge
+//   pit   - steps to the next pit
+//   flame - steps to the next flamethrower
+// Values are capped at LIMIT, which is more than any robot can move, so LIMIT means "not in reach".
+// That cap also bounds the work when a cell changes: only the LIMIT cells behind it in each
+// direction can see the change.
+// A sparse grid gets no tables (they would cost 24 bytes for every cell on the board), there the
+// lookups walk the grid instead, which for a move of at most LIMIT cells is still cheap. That
+// includes a grid on a map's shared obstacles, where the tables would cost more than the grid.
+// Small boards scan too: walks hit the edge within a few cells, and keeping the tables in step
+// on every move costs more than the lookups save.
+class JumpTables
+{
+public:
+    static constexpr int LIMIT = 15;
+    static constexpr long long SMALL_BOARD_CELLS = 32 * 32; // this many cells or fewer scans
+
+    explicit JumpTables(const Grid& grid);
+
+    // Recompute everything, for after bulk changes like placing all the obstacles
+    void build();
+
+    // Call after the type of a cell changes
+    void cellChanged(int row, int col);
+
+    // direction is 1-8, as in RobotBase.h
+    int freeSteps(int direction, int row, int col) const
+    {
+        return tabulated ? free[index(direction, row, col)] : scan(direction, row, col, FREE);
+    }
+    int stepsToPit(int direction, int row, int col) const
+    {
+        return tabulated ? pit[index(direction, row, col)] : scan(direction, row, col, PIT);
+    }
+    int stepsToFlame(int direction, int row, int col) const
+    {
+        return tabulated ? flame[index(direction, row, col)] : scan(direction, row, col, FLAME);
+    }
+
+    size_t bytes() const { return free.size() + pit.size() + flame.size(); }
+
+private:
+    enum Lookup { FREE, PIT, FLAME };
+
+    size_t index(int direction, int row, int col) const
+    {
+        return (static_cast<size_t>(direction - 1) * rows + row) * cols + col;
+    }
+
+    // Recompute one cell from its neighbour in that direction, returns true if anything changed
+    bool update(int direction, int row, int col);
+
+    // The same answers worked out from the grid, for when there are no tables
+    int scan(int direction, int row, int col, Lookup lookup) const;
+
+    const Grid& grid;
+    int rows;
+    int cols;
+    bool tabulated;
+    std::vector<uint8_t> free;
+    std::vector<uint8_t> pit;
+    std::vector<uint8_t> flame;
+};
+
+#endif // JUMP_TABLES_H
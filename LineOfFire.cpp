@@ -0,0 +1,31 @@
+#include "LineOfFire.h"
+
+// One period of the reduced direction (dRow, dCol): steps 1 .. max(|dRow|, |dCol|)
+const std::vector<CellOffset>& RayCache::rasterize(int dRow, int dCol)
+{
+    uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(dRow)) << 32) | static_cast<uint32_t>(dCol);
+    auto found = rays.find(key);
+    if (found != rays.end())
+    {
+        return found->second;
+    }
+
+    if (rays.size() >= MAX_RAYS)
+    {
+        rays.clear();
+    }
+
+    int major = std::max(std::abs(dRow), std::abs(dCol));
+    std::vector<CellOffset> period(major);
+    for (int step = 1; step <= major; ++step)
+    {
+        // step * d / major, rounded half away from zero, in integers
+        auto along = [&](int d) {
+            int scaled = (2 * step * std::abs(d) + major) / (2 * major);
+            return d < 0 ? -scaled : scaled;
+        };
+        period[step - 1] = CellOffset{along(dRow), along(dCol)};
+    }
+
+    return rays.emplace(key, std::move(period)).first->second;
+}
@@ -0,0 +1,75 @@
+#ifndef LINE_OF_FIRE_H
+#define LINE_OF_FIRE_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <unordered_map>
+#include <vector>
+#include "Weapons.h"
+
+// Straight lines across the grid, the way shots travel: one cell per step along the longer axis,
+// the shorter axis rounded to the nearest cell. From (2,2) aiming at (4,5) that is
+// (3,3), (3,4), (4,5), (5,6), (5,7), (6,8), (7,9) - the railgun example in the spec.
+//
+// Every aim point with the same direction reduced by gcd walks the same cells, and after
+// max(|dRow|, |dCol|) steps of the reduced direction the pattern repeats shifted by (dRow, dCol).
+// So only that one period is rasterized, once per direction, and cached.
+class RayCache
+{
+public:
+    // Call visit(rowOffset, colOffset) for up to maxSteps cells along the line towards (dRow, dCol),
+    // stopping early when visit returns false. Offsets are relative to the start; (0, 0) is skipped.
+    template <typename Visit>
+    void walk(int dRow, int dCol, int maxSteps, Visit&& visit)
+    {
+        if (dRow == 0 && dCol == 0)
+        {
+            return;
+        }
+
+        int divisor = gcd(std::abs(dRow), std::abs(dCol));
+        dRow /= divisor;
+        dCol /= divisor;
+        const std::vector<CellOffset>& period = rasterize(dRow, dCol);
+
+        int baseRow = 0, baseCol = 0;
+        size_t i = 0;
+        for (int step = 0; step < maxSteps; ++step)
+        {
+            if (!visit(baseRow + period[i].row, baseCol + period[i].col))
+            {
+                return;
+            }
+            if (++i == period.size())
+            {
+                i = 0;
+                baseRow += dRow;
+                baseCol += dCol;
+            }
+        }
+    }
+
+    size_t size() const { return rays.size(); }
+
+private:
+    static int gcd(int a, int b)
+    {
+        while (b)
+        {
+            int t = a % b;
+            a = b;
+            b = t;
+        }
+        return a;
+    }
+
+    const std::vector<CellOffset>& rasterize(int dRow, int dCol);
+
+    // A huge board aimed at from everywhere could collect a lot of directions, so the cache
+    // is simply emptied when it gets this big
+    static constexpr size_t MAX_RAYS = 4096;
+
+    std::unordered_map<uint64_t, std::vector<CellOffset>> rays;
+};
+
+#endif // LINE_OF_FIRE_H
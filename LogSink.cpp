@@ -0,0 +1,333 @@
+#include "LogSink.h"
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include "Cell.h"
+
+namespace
+{
+
+// How long the writer sleeps when the ring is empty. Games never wait on it; drain() wakes it.
+constexpr auto IDLE_WAIT = std::chrono::milliseconds(2);
+
+void appendInt(std::string& out, int32_t value)
+{
+    char digits[12];
+    char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    out.append(digits, end);
+}
+
+// The text the arena printed for each event, character for character
+void format(std::string& out, const LogRecord& record)
+{
+    std::string_view name(record.text, record.length);
+    switch (record.event)
+    {
+        case LogEvent::Text:
+            out += name;
+            break;
+        case LogEvent::Round:
+            out += "\n=========== Round ";
+            appendInt(out, record.a);
+            out += " ===========\n";
+            break;
+        case LogEvent::Turn:
+            out += name;
+            out += "'s turn:\t";
+            appendInt(out, record.a);
+            out += "/100\t(";
+            appendInt(out, record.c);
+            out += ',';
+            appendInt(out, record.b);
+            out += ")\n";
+            break;
+        case LogEvent::EndLine:
+            out += '\n';
+            break;
+        case LogEvent::RadarDirection:
+            out += "Radar Directions:";
+            appendInt(out, record.a);
+            out += '\n';
+            break;
+        case LogEvent::RadarResults:
+            out += "Radar Results for ";
+            out += name;
+            out += ": ";
+            break;
+        case LogEvent::RadarObject:
+            out += " Type: ";
+            out += static_cast<char>(record.a);
+            out += " (";
+            appendInt(out, record.c);
+            out += ", ";
+            appendInt(out, record.b);
+            out += ")  ";
+            break;
+        case LogEvent::Shooting:
+            out += "Shooting: ";
+            out += name;
+            out += " shoots at (";
+            appendInt(out, record.c);
+            out += ", ";
+            appendInt(out, record.b);
+            out += ")\n";
+            break;
+        case LogEvent::ResolvingShot:
+            out += "Resolving shot at (";
+            appendInt(out, record.c);
+            out += ',';
+            appendInt(out, record.b);
+            out += ")\n";
+            break;
+        case LogEvent::OutOfRange:
+            out += name;
+            out += " can only reach ";
+            appendInt(out, record.a);
+            out += " cell(s).\n";
+            break;
+        case LogEvent::HitRobot:
+            out += "Hit robot: ";
+            out += name;
+            out += '\n';
+            break;
+        case LogEvent::HitObstacle:
+            out += "Shot hit an obstacle: ";
+            if (record.a == OBSTACLE_FLAMETHROWER) out += "Flamethrower\n";
+            else if (record.a == OBSTACLE_PIT) out += "Pit\n";
+            else if (record.a == OBSTACLE_MOUND) out += "Mound\n";
+            break;
+        case LogEvent::Moves:
+            out += name;
+            out += " moves to (";
+            appendInt(out, record.b);
+            out += ", ";
+            appendInt(out, record.c);
+            out += ")\n";
+            break;
+        case LogEvent::OverMemoryCap:
+            out += name;
+            out += " went over its memory cap of ";
+            appendInt(out, record.a);
+            out += " KiB and is shut down!\n";
+            break;
+        case LogEvent::OutOfAmmo:   out += name; out += " is out of grenades!\n"; break;
+        case LogEvent::Destroyed:   out += name; out += " is destroyed!\n"; break;
+        case LogEvent::Trapped:     out += name; out += " is trapped in a pit and cannot move!\n"; break;
+        case LogEvent::OutOfBounds: out += name; out += " attempted to move out of bounds.\n"; break;
+        case LogEvent::HitMound:    out += name; out += " hit a mound and cannot move there!\n"; break;
+        case LogEvent::HitWreck:    out += name; out += " hit a dead robot and cannot move there!\n"; break;
+        case LogEvent::Collided:    out += name; out += " collided with another robot.\n"; break;
+        case LogEvent::FlameDamage: out += name; out += " took flamethrower damage!\n"; break;
+        case LogEvent::FellInPit:   out += name; out += " fell into a pit and is stuck!\n"; break;
+        case LogEvent::Death:       out += name; out += " got absolutely destroyed!\n\n"; break;
+        case LogEvent::Open:
+        case LogEvent::Flush:
+        case LogEvent::Close:
+            break; // handled by the writer
+    }
+}
+
+} // namespace
+
+LogSink::LogSink(std::ostream& out, bool labelled, size_t capacity)
+: out(out), labelled(labelled), mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1), ring(new Slot[mask + 1])
+{
+    start();
+}
+
+LogSink::LogSink(const std::string& path, bool labelled, size_t capacity)
+: file(path, std::ios::binary | std::ios::trunc), out(file), labelled(labelled),
+  mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1), ring(new Slot[mask + 1])
+{
+    start();
+}
+
+void LogSink::start()
+{
+    // Slot i is free for the producer that claims position i
+    for (size_t i = 0; i <= mask; ++i)
+    {
+        ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    writer = std::thread(&LogSink::run, this);
+}
+
+LogSink::~LogSink()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+}
+
+const std::shared_ptr<LogSink>& LogSink::standardOutput()
+{
+    static const std::shared_ptr<LogSink> sink = std::make_shared<LogSink>(std::cout);
+    return sink;
+}
+
+uint32_t LogSink::open(const std::string& label)
+{
+    uint32_t source = nextSource.fetch_add(1, std::memory_order_relaxed);
+    push(source, LogEvent::Open, label);
+    return source;
+}
+
+void LogSink::push(uint32_t source, LogEvent event, std::string_view text, int32_t a, int32_t b, int32_t c)
+{
+    // Claim the next position. Its slot is ours once the writer has released it from the last
+    // time round the ring, which the slot's sequence number says.
+    uint64_t pos = head.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;)
+    {
+        slot = &ring[pos & mask];
+        int64_t lag = static_cast<int64_t>(slot->sequence.load(std::memory_order_acquire) - pos);
+        if (lag == 0)
+        {
+            if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (lag < 0)
+        {
+            // Full: nudge the writer and wait for it to catch up
+            wake.notify_one();
+            std::this_thread::yield();
+            pos = head.load(std::memory_order_relaxed);
+        }
+        else
+        {
+            pos = head.load(std::memory_order_relaxed); // someone else got it first
+        }
+    }
+
+    LogRecord& record = slot->record;
+    record.source = source;
+    record.event = event;
+    record.length = static_cast<uint8_t>(std::min(text.size(), LogRecord::TEXT_BYTES));
+    std::memcpy(record.text, text.data(), record.length);
+    record.a = a;
+    record.b = b;
+    record.c = c;
+    slot->sequence.store(pos + 1, std::memory_order_release);
+}
+
+void LogSink::pushText(uint32_t source, std::string_view text)
+{
+    for (size_t at = 0; at < text.size(); at += LogRecord::TEXT_BYTES)
+    {
+        push(source, LogEvent::Text, text.substr(at, LogRecord::TEXT_BYTES));
+    }
+}
+
+void LogSink::drain()
+{
+    uint64_t target = head.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(mutex);
+    wake.notify_one();
+    drained.wait(lock, [&] { return consumed >= target; });
+}
+
+void LogSink::run()
+{
+    struct Pending
+    {
+        std::string label;
+        std::string text;
+    };
+    std::map<uint32_t, Pending> sources;
+    std::string batch;
+    bool wroteAny = false;
+    uint32_t lastWritten = 0;
+
+    // Move a source's text into the batch that's about to be written
+    auto release = [&](uint32_t source, Pending& pending)
+    {
+        if (pending.text.empty())
+        {
+            return;
+        }
+        if (labelled && (!wroteAny || source != lastWritten))
+        {
+            batch += "--- " + pending.label + " ---\n";
+        }
+        batch += pending.text;
+        pending.text.clear();
+        lastWritten = source;
+        wroteAny = true;
+    };
+
+    // Checked under the lock after a pass, so the pass after it sees everything pushed before the
+    // destructor ran
+    bool last = false;
+    for (;;)
+    {
+        uint64_t start = tail;
+        for (;;)
+        {
+            Slot& slot = ring[tail & mask];
+            if (slot.sequence.load(std::memory_order_acquire) != tail + 1)
+            {
+                break;
+            }
+
+            const LogRecord& record = slot.record;
+            auto it = sources.try_emplace(record.source).first;
+            switch (record.event)
+            {
+                case LogEvent::Open:
+                    it->second.label.assign(record.text, record.length);
+                    break;
+                case LogEvent::Flush:
+                    release(it->first, it->second);
+                    break;
+                case LogEvent::Close:
+                    release(it->first, it->second);
+                    sources.erase(it);
+                    break;
+                default:
+                    format(it->second.text, record);
+                    break;
+            }
+
+            // Free the slot for the producer that comes round to it next
+            slot.sequence.store(tail + mask + 1, std::memory_order_release);
+            ++tail;
+        }
+
+        if (last)
+        {
+            for (auto& [source, pending] : sources)
+            {
+                release(source, pending); // games that never finished a round
+            }
+        }
+        if (!batch.empty())
+        {
+            out.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+            out.flush();
+            batch.clear();
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        consumed = tail;
+        drained.notify_all();
+        if (last)
+        {
+            break;
+        }
+        if (tail == start && !stopping)
+        {
+            wake.wait_for(lock, IDLE_WAIT);
+        }
+        last = stopping;
+    }
+}
@@ -0,0 +1,127 @@
+#ifndef LOG_SINK_H
+#define LOG_SINK_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// The lines of the turn log. Most carry a robot name and up to three numbers; the sink turns
+// them into exactly the text the arena used to print itself.
+enum class LogEvent : uint8_t
+{
+    Open,           // text = label of a new source
+    Text,           // text as is, longer text comes in several records
+    Flush,          // a game finished a round: its text so far can go out
+    Close,          // a game is over, flush it and forget it
+    Round,          // a = round
+    Turn,           // name, a = health, b = row, c = col
+    EndLine,
+    RadarDirection, // a = direction
+    RadarResults,   // name, the objects follow as RadarObject and an EndLine
+    RadarObject,    // a = type character, b = row, c = col
+    Shooting,       // name, b = row, c = col
+    ResolvingShot,  // b = row, c = col
+    OutOfRange,     // text = weapon name, a = range
+    OutOfAmmo,      // name
+    HitRobot,       // name
+    Destroyed,      // name
+    HitObstacle,    // a = CellType
+    Trapped,        // name
+    Moves,          // name, b = row, c = col
+    OutOfBounds,    // name
+    HitMound,       // name
+    HitWreck,       // name
+    Collided,       // name
+    FlameDamage,    // name
+    FellInPit,      // name
+    Death,          // name
+    OverMemoryCap   // name, a = cap in KiB
+};
+
+// One queued event, a cache line. Names longer than the text field are cut short.
+struct LogRecord
+{
+    static constexpr size_t TEXT_BYTES = 46;
+
+    uint32_t source;
+    LogEvent event;
+    uint8_t length;
+    char text[TEXT_BYTES];
+    int32_t a, b, c;
+};
+static_assert(sizeof(LogRecord) == 64);
+
+// Formats and writes game logs on a thread of its own.
+//
+// Arenas push LogRecords into a bounded ring that any number of threads can push to without
+// taking a lock (every slot has a sequence number saying whose turn it is; a producer claims a
+// slot with one compare and swap). The writer thread drains the ring, formats the records and
+// writes what it has in one go. Logging a line costs the game a copy of 64 bytes.
+//
+// Several games can share a sink. Each opens a source and the writer keeps each source's text
+// apart until the game flushes it at the end of a round, so rounds of different games never mix.
+// A labelled sink puts a "--- label ---" line in front whenever the output switches games.
+//
+// When the ring is full, pushing waits for the writer: the log never drops lines.
+class LogSink
+{
+public:
+    explicit LogSink(std::ostream& out, bool labelled = false, size_t capacity = DEFAULT_CAPACITY);
+    explicit LogSink(const std::string& path, bool labelled = true, size_t capacity = DEFAULT_CAPACITY);
+    ~LogSink(); // writes out everything still queued
+
+    LogSink(const LogSink&) = delete;
+    LogSink& operator=(const LogSink&) = delete;
+
+    // The sink verbose arenas use unless they're given one, writing to std::cout
+    static const std::shared_ptr<LogSink>& standardOutput();
+
+    bool good() const { return out.good(); }
+
+    // A new source of log lines, one per game
+    uint32_t open(const std::string& label);
+
+    void push(uint32_t source, LogEvent event, std::string_view text = {}, int32_t a = 0, int32_t b = 0, int32_t c = 0);
+    void pushText(uint32_t source, std::string_view text);
+
+    // Wait until everything pushed so far is formatted and everything flushed is written
+    void drain();
+
+private:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 14;
+
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence;
+        LogRecord record;
+    };
+
+    std::ofstream file;
+    std::ostream& out;
+    bool labelled;
+    size_t mask;
+    std::unique_ptr<Slot[]> ring;
+
+    alignas(64) std::atomic<uint64_t> head{0}; // next slot to claim
+    alignas(64) uint64_t tail = 0;             // next slot to read, writer thread only
+    std::atomic<uint32_t> nextSource{0};
+
+    std::mutex mutex;
+    std::condition_variable wake;    // writer waits on this when the ring is empty
+    std::condition_variable drained; // drain waits on this
+    uint64_t consumed = 0;           // records the writer is done with, under mutex
+    bool stopping = false;
+    std::thread writer;
+
+    void start();
+    void run();
+};
+
+#endif // LOG_SINK_H
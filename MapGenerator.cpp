@@ -0,0 +1,346 @@
+#include "MapGenerator.h"
+#include <algorithm>
+
+namespace
+{
+
+// A layout that loses this share of its open cells to pocket filling has fallen apart, try again
+constexpr double MAX_FILLED_SHARE = 0.5;
+// Nor is one with less than this share of the board left empty: robots only spawn on empty cells
+constexpr double MIN_EMPTY_SHARE = 0.2;
+constexpr int MAX_ATTEMPTS = 5; // of the style asked for, then one of scatter that is kept whatever
+
+// Cells a robot can move through
+bool isOpen(uint8_t type)
+{
+    return type == EMPTY || type == OBSTACLE_FLAMETHROWER;
+}
+
+} // namespace
+
+bool parseMapStyle(const std::string& name, MapStyle& style)
+{
+    if (name == "scatter")       style = MapStyle::Scatter;
+    else if (name == "caves")    style = MapStyle::Caves;
+    else if (name == "maze")     style = MapStyle::Maze;
+    else if (name == "clusters") style = MapStyle::Clusters;
+    else return false;
+    return true;
+}
+
+MapGenerator::MapGenerator(int rows, int cols, std::mt19937& rng)
+: rows(rows), cols(cols), rng(rng), cells(static_cast<size_t>(rows) * cols, EMPTY)
+{
+}
+
+ObstacleLayout MapGenerator::generate(int rows, int cols, MapStyle style, bool symmetric, std::mt19937& rng)
+{
+    for (int attempt = 1; ; ++attempt)
+    {
+        // Out of attempts: the original scatter, which leaves most of any board open
+        bool last = attempt > MAX_ATTEMPTS;
+        MapGenerator generator(rows, cols, rng);
+        switch (last ? MapStyle::Scatter : style)
+        {
+            case MapStyle::Scatter:
+            {
+                ObstacleLayout scattered = ObstacleLayout::scatter(rows, cols, rng);
+                for (int r = 0; r < rows; ++r)
+                {
+                    for (int c = 0; c < cols; ++c)
+                    {
+                        generator.cell(r, c) = scattered.at(r, c);
+                    }
+                }
+                break;
+            }
+            case MapStyle::Caves:    generator.caves(); break;
+            case MapStyle::Maze:     generator.maze(); break;
+            case MapStyle::Clusters: generator.clusters(); break;
+        }
+        if (symmetric)
+        {
+            generator.mirror();
+        }
+
+        uint64_t open = std::count_if(generator.cells.begin(), generator.cells.end(), isOpen);
+        std::vector<uint8_t> unfilled;
+        if (symmetric && last)
+        {
+            unfilled = generator.cells;
+        }
+        uint64_t filled = fillPockets(generator.cells, rows, cols, symmetric);
+        if (open > 0 && filled == open && !unfilled.empty())
+        {
+            // Out of attempts and no region is its own rotation: connected beats symmetric
+            generator.cells = std::move(unfilled);
+            filled = fillPockets(generator.cells, rows, cols);
+        }
+        uint64_t empty = std::count(generator.cells.begin(), generator.cells.end(), EMPTY);
+        if ((filled < open * MAX_FILLED_SHARE && empty >= generator.cells.size() * MIN_EMPTY_SHARE) || last)
+        {
+            ObstacleLayout layout(rows, cols);
+            for (int r = 0; r < rows; ++r)
+            {
+                for (int c = 0; c < cols; ++c)
+                {
+                    if (generator.cell(r, c) != EMPTY)
+                    {
+                        layout.set(r, c, static_cast<CellType>(generator.cell(r, c)));
+                    }
+                }
+            }
+            return layout;
+        }
+    }
+}
+
+uint64_t MapGenerator::fillPockets(std::vector<uint8_t>& cells, int rows, int cols, bool symmetric)
+{
+    // Label the open regions with a flood fill each, 8-connected like robot movement
+    const int32_t unlabelled = -1;
+    std::vector<int32_t> label(cells.size(), unlabelled);
+    std::vector<uint64_t> sizes;
+    std::vector<size_t> starts; // a cell of each region
+    std::vector<size_t> queue;
+
+    for (size_t start = 0; start < cells.size(); ++start)
+    {
+        if (!isOpen(cells[start]) || label[start] != unlabelled)
+        {
+            continue;
+        }
+
+        int32_t region = static_cast<int32_t>(sizes.size());
+        label[start] = region;
+        queue.assign(1, start);
+        for (size_t head = 0; head < queue.size(); ++head)
+        {
+            int row = static_cast<int>(queue[head] / cols);
+            int col = static_cast<int>(queue[head] % cols);
+            for (int direction = 1; direction <= 8; ++direction)
+            {
+                int r = row + directions[direction].first;
+                int c = col + directions[direction].second;
+                if (r < 0 || r >= rows || c < 0 || c >= cols)
+                {
+                    continue;
+                }
+                size_t next = static_cast<size_t>(r) * cols + c;
+                if (isOpen(cells[next]) && label[next] == unlabelled)
+                {
+                    label[next] = region;
+                    queue.push_back(next);
+                }
+            }
+        }
+        sizes.push_back(queue.size());
+        starts.push_back(start);
+    }
+
+    if (sizes.empty())
+    {
+        return 0;
+    }
+
+    int32_t biggest = static_cast<int32_t>(std::max_element(sizes.begin(), sizes.end()) - sizes.begin());
+    if (symmetric)
+    {
+        // The rotation takes every region onto a region. Keeping one that isn't its own rotation
+        // would fill in its image and leave the board lopsided, so only those that are count.
+        biggest = unlabelled;
+        for (size_t region = 0; region < sizes.size(); ++region)
+        {
+            bool ownImage = label[cells.size() - 1 - starts[region]] == static_cast<int32_t>(region);
+            if (ownImage && (biggest == unlabelled || sizes[region] > sizes[biggest]))
+            {
+                biggest = static_cast<int32_t>(region);
+            }
+        }
+    }
+    uint64_t filled = 0;
+    for (size_t i = 0; i < cells.size(); ++i)
+    {
+        if (label[i] != unlabelled && label[i] != biggest)
+        {
+            cells[i] = OBSTACLE_MOUND;
+            ++filled;
+        }
+    }
+    return filled;
+}
+
+// Start from noise and smooth it: a cell becomes a mound when most of its 3x3 block is mounds.
+// Off the board counts as mound, so the caverns close off at the edges.
+void MapGenerator::caves()
+{
+    // 0/1 mound flags with a border of mounds all round, so counting needs no bounds checks
+    int width = cols + 2;
+    std::vector<uint8_t> mound(static_cast<size_t>(rows + 2) * width, 1);
+    std::vector<uint8_t> next(mound.size(), 1);
+    for (int r = 1; r <= rows; ++r)
+    {
+        for (int c = 1; c <= cols; ++c)
+        {
+            mound[static_cast<size_t>(r) * width + c] = chance(0.45);
+        }
+    }
+
+    for (int pass = 0; pass < 4; ++pass)
+    {
+        for (int r = 1; r <= rows; ++r)
+        {
+            const uint8_t* up = &mound[static_cast<size_t>(r - 1) * width];
+            const uint8_t* mid = up + width;
+            const uint8_t* down = mid + width;
+            uint8_t* out = &next[static_cast<size_t>(r) * width];
+            for (int c = 1; c <= cols; ++c)
+            {
+                int mounds = up[c - 1] + up[c] + up[c + 1] + mid[c - 1] + mid[c] + mid[c + 1]
+                           + down[c - 1] + down[c] + down[c + 1];
+                out[c] = mounds >= 5;
+            }
+        }
+        mound.swap(next);
+    }
+
+    for (int r = 0; r < rows; ++r)
+    {
+        for (int c = 0; c < cols; ++c)
+        {
+            cell(r, c) = mound[static_cast<size_t>(r + 1) * width + c + 1] ? OBSTACLE_MOUND : EMPTY;
+        }
+    }
+
+    hazards(0.01, 0.02);
+}
+
+// Recursive backtracker over 2x2 rooms with one-cell walls between them: room (i, j) has its
+// top left corner at (3i + 1, 3j + 1)
+void MapGenerator::maze()
+{
+    int roomRows = (rows - 1) / 3;
+    int roomCols = (cols - 1) / 3;
+    if (roomRows < 1 || roomCols < 1)
+    {
+        return; // too small for a maze, leave it open
+    }
+
+    std::fill(cells.begin(), cells.end(), OBSTACLE_MOUND);
+    auto carve = [&](int top, int left, int height, int width)
+    {
+        for (int r = top; r < top + height; ++r)
+        {
+            for (int c = left; c < left + width; ++c)
+            {
+                cell(r, c) = EMPTY;
+            }
+        }
+    };
+
+    static const int steps[4][2] = { {-1, 0}, {1, 0}, {0, -1}, {0, 1} };
+    std::vector<char> visited(static_cast<size_t>(roomRows) * roomCols, 0);
+    std::vector<int> stack = { 0 };
+    visited[0] = 1;
+    carve(1, 1, 2, 2);
+
+    while (!stack.empty())
+    {
+        int i = stack.back() / roomCols;
+        int j = stack.back() % roomCols;
+
+        int options[4];
+        int count = 0;
+        for (int k = 0; k < 4; ++k)
+        {
+            int ni = i + steps[k][0];
+            int nj = j + steps[k][1];
+            if (ni >= 0 && ni < roomRows && nj >= 0 && nj < roomCols && !visited[ni * roomCols + nj])
+            {
+                options[count++] = k;
+            }
+        }
+        if (count == 0)
+        {
+            stack.pop_back();
+            continue;
+        }
+
+        int k = options[randomInt(0, count - 1)];
+        int ni = i + steps[k][0];
+        int nj = j + steps[k][1];
+        // Both rooms and the wall between them
+        carve(3 * std::min(i, ni) + 1, 3 * std::min(j, nj) + 1, ni != i ? 5 : 2, nj != j ? 5 : 2);
+        visited[ni * roomCols + nj] = 1;
+        stack.push_back(ni * roomCols + nj);
+    }
+
+    // Knock through some of the walls left standing so there's more than one way around
+    for (int i = 0; i < roomRows; ++i)
+    {
+        for (int j = 0; j < roomCols; ++j)
+        {
+            if (j + 1 < roomCols && chance(0.1))
+            {
+                carve(3 * i + 1, 3 * j + 3, 2, 1);
+            }
+            if (i + 1 < roomRows && chance(0.1))
+            {
+                carve(3 * i + 3, 3 * j + 1, 1, 2);
+            }
+        }
+    }
+
+    hazards(0.005, 0.01);
+}
+
+// Short random walks leave clumps of mounds, about 6% of the board
+void MapGenerator::clusters()
+{
+    long long clumps = static_cast<long long>(rows) * cols / 200;
+    for (long long i = 0; i < clumps; ++i)
+    {
+        int r = randomInt(0, rows - 1);
+        int c = randomInt(0, cols - 1);
+        int length = randomInt(10, 30);
+        for (int step = 0; step < length; ++step)
+        {
+            cell(r, c) = OBSTACLE_MOUND;
+            int direction = randomInt(1, 8);
+            r = std::clamp(r + directions[direction].first, 0, rows - 1);
+            c = std::clamp(c + directions[direction].second, 0, cols - 1);
+        }
+    }
+
+    hazards(0.01, 0.02);
+}
+
+// Sprinkle pits and flamethrowers over open ground
+void MapGenerator::hazards(double pitChance, double flameChance)
+{
+    for (uint8_t& type : cells)
+    {
+        if (type != EMPTY)
+        {
+            continue;
+        }
+        if (chance(pitChance))
+        {
+            type = OBSTACLE_PIT;
+        }
+        else if (chance(flameChance))
+        {
+            type = OBSTACLE_FLAMETHROWER;
+        }
+    }
+}
+
+// Copy the first half of the board onto the second, rotated 180 degrees
+void MapGenerator::mirror()
+{
+    size_t total = cells.size();
+    for (size_t i = 0; i < total / 2; ++i)
+    {
+        cells[total - 1 - i] = cells[i];
+    }
+}
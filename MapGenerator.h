@@ -0,0 +1,63 @@
+#ifndef MAP_GENERATOR_H
+#define MAP_GENERATOR_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "ObstacleLayout.h"
+
+enum class MapStyle
+{
+    Scatter,  // the original: about one cell in ten gets a random obstacle
+    Caves,    // cellular automaton caverns walled with mounds
+    Maze,     // two-wide corridors between mound walls, with some loops knocked through
+    Clusters  // clumps of mounds with open ground between them
+};
+
+// Parses "scatter", "caves", "maze" or "clusters", false if it's none of them
+bool parseMapStyle(const std::string& name, MapStyle& style);
+
+// Builds obstacle layouts for the arena.
+//
+// Every layout comes out connected: robots move in 8 directions and are stopped by mounds and
+// trapped by pits, so the open cells (empty or flamethrower) are flood filled and every pocket
+// that can't reach the biggest open region is filled in with mounds. Whatever empty cell a robot
+// spawns on, it can reach every other robot. If too much of a layout had to be filled, or too
+// little of the board is left empty to spawn on, it is thrown away and generated again; after a
+// few tries the original scatter is used instead.
+//
+// With symmetric set, the layout is the same rotated 180 degrees, so neither half of the board
+// is better to spawn in. The pockets are filled so it stays that way. Only when not even the
+// scatter has an open region that is its own rotation does it come out connected but lopsided.
+class MapGenerator
+{
+public:
+    static ObstacleLayout generate(int rows, int cols, MapStyle style, bool symmetric, std::mt19937& rng);
+
+    // Fill every open pocket not connected to the biggest open region. Returns the cells filled.
+    // For a layout that is the same rotated 180 degrees, symmetric keeps the biggest region that
+    // is its own rotation instead, so the layout stays symmetric; with no such region it fills
+    // every open cell.
+    static uint64_t fillPockets(std::vector<uint8_t>& cells, int rows, int cols, bool symmetric = false);
+
+private:
+    MapGenerator(int rows, int cols, std::mt19937& rng);
+
+    void caves();
+    void maze();
+    void clusters();
+    void hazards(double pitChance, double flameChance);
+    void mirror();
+
+    bool chance(double p) { return std::uniform_real_distribution<double>(0.0, 1.0)(rng) < p; }
+    int randomInt(int low, int high) { return std::uniform_int_distribution<int>(low, high)(rng); }
+    uint8_t& cell(int row, int col) { return cells[static_cast<size_t>(row) * cols + col]; }
+
+    int rows;
+    int cols;
+    std::mt19937& rng;
+    std::vector<uint8_t> cells; // CellType per cell, row-major
+};
+
+#endif // MAP_GENERATOR_H
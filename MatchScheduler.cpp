@@ -0,0 +1,208 @@
+#include "MatchScheduler.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <ctime>
+#include <thread>
+
+MatchScheduler::MatchScheduler(const std::vector<std::string>& robotLibs, const SchedulerConfig& config)
+: libs(robotLibs), config(config),
+  rng(config.seed ? config.seed : static_cast<unsigned>(std::time(nullptr))),
+  ratings(robotLibs.size(), 1500.0), games(robotLibs.size(), 0), wins(robotLibs.size(), 0),
+  peakHeaps(robotLibs.size(), 0)
+{
+    this->config.groupSize = std::max(2, config.groupSize);
+    this->config.workers = std::max(1, config.workers);
+    this->config.arena.verbose = config.arena.log != nullptr; // games only log when there's a file for it
+
+    for (const std::string& lib : libs) {
+        registry.add(lib);
+    }
+    registry.validateAll();
+}
+
+MatchScheduler::~MatchScheduler() = default;
+
+// Split an ordering of robots into consecutive groups of roughly groupSize.
+// Leftovers are spread over the groups so nobody ends up playing alone.
+std::vector<std::vector<int>> MatchScheduler::makeGroups(const std::vector<int>& order) const
+{
+    int n = static_cast<int>(order.size());
+    int groupCount = std::max(1, n / config.groupSize);
+    std::vector<std::vector<int>> groups(groupCount);
+
+    int pos = 0;
+    for (int g = 0; g < groupCount; ++g) {
+        int size = n / groupCount + (g < n % groupCount ? 1 : 0);
+        groups[g].assign(order.begin() + pos, order.begin() + pos + size);
+        pos += size;
+    }
+    return groups;
+}
+
+// Build the games for one round
+std::vector<MatchSpec> MatchScheduler::pairRound(int round)
+{
+    std::vector<int> order;
+    for (int id = 0; id < static_cast<int>(libs.size()); ++id) {
+        if (registry.isValid(id)) {
+            order.push_back(id);
+        }
+    }
+    int n = static_cast<int>(order.size());
+
+    switch (config.mode) {
+        case PairingMode::RoundRobin: {
+            // Circle method: robot 0 stays put, the rest rotate one seat per round.
+            // Seats are dealt across the groups so neighbours in the circle get split up.
+            std::vector<int> seats(n);
+            for (int i = 0; i < n; ++i) {
+                seats[i] = order[(i == 0 || n < 2) ? i : 1 + (i - 1 + round) % (n - 1)];
+            }
+            int groupCount = std::max(1, n / config.groupSize);
+            order.clear();
+            for (int g = 0; g < groupCount; ++g) {
+                for (int i = g; i < n; i += groupCount) {
+                    order.push_back(seats[i]);
+                }
+            }
+            break;
+        }
+        case PairingMode::Swiss:
+            // First round is random, after that robots play others with a similar rating
+            std::shuffle(order.begin(), order.end(), rng);
+            if (round > 0) {
+                std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+                    return ratings[a] > ratings[b];
+                });
+            }
+            break;
+        case PairingMode::Random:
+            std::shuffle(order.begin(), order.end(), rng);
+            break;
+    }
+
+    std::vector<MatchSpec> matches;
+    if (n < 2) {
+        return matches;
+    }
+    for (auto& group : makeGroups(order)) {
+        MatchSpec match;
+        match.id = nextMatchId++;
+        match.round = round;
+        match.robots = std::move(group);
+        match.seed = rng();
+        matches.push_back(std::move(match));
+    }
+    return matches;
+}
+
+// Run a single headless game
+MatchResult MatchScheduler::playMatch(const MatchSpec& match)
+{
+    ArenaConfig arenaConfig = config.arena;
+    arenaConfig.seed = match.seed;
+
+    Arena arena(arenaConfig);
+    arena.placeObstacles();
+    arena.loadRobots(registry, match.robots);
+
+    return MatchResult{match, arena.startBattle()};
+}
+
+// Multiplayer Elo: every pair of robots in the game counts as one head-to-head result
+void MatchScheduler::recordResult(const MatchResult& result)
+{
+    totalProfile.merge(result.game.profile);
+
+    const auto& robots = result.match.robots;
+    const auto& finish = result.game.finishRound;
+    if (finish.size() != robots.size()) {
+        return; // a library failed to load, slots don't line up - no contest
+    }
+
+    int n = static_cast<int>(robots.size());
+    std::vector<double> delta(n, 0.0);
+    const double K = 32.0 / (n - 1);
+
+    for (int a = 0; a < n; ++a) {
+        int lastedA = finish[a] < 0 ? INT_MAX : finish[a];
+        for (int b = a + 1; b < n; ++b) {
+            int lastedB = finish[b] < 0 ? INT_MAX : finish[b];
+            double score = lastedA > lastedB ? 1.0 : (lastedA < lastedB ? 0.0 : 0.5);
+            double expected = 1.0 / (1.0 + std::pow(10.0, (ratings[robots[b]] - ratings[robots[a]]) / 400.0));
+            delta[a] += K * (score - expected);
+            delta[b] -= K * (score - expected);
+        }
+    }
+
+    for (int i = 0; i < n; ++i) {
+        ratings[robots[i]] += delta[i];
+        ++games[robots[i]];
+        if (static_cast<size_t>(i) < result.game.memory.size()) {
+            peakHeaps[robots[i]] = std::max(peakHeaps[robots[i]], result.game.memory[i].peak);
+        }
+    }
+    if (!result.game.draw && !result.game.placement.empty()) {
+        ++wins[robots[result.game.placement.front()]];
+    }
+}
+
+void MatchScheduler::run(const std::function<void(const MatchResult&)>& onResult)
+{
+    for (int round = 0; round < config.rounds; ++round) {
+        std::vector<MatchSpec> matches = pairRound(round);
+
+        if (config.processes > 0) {
+            if (!pool) {
+                pool = std::make_unique<WorkerPool>(libs, config.arena, config.mapPath, config.processes, config.gameTimeout);
+            }
+            pool->play(matches, [&](const MatchResult& result) {
+                recordResult(result);
+                if (onResult) {
+                    onResult(result);
+                }
+            });
+            continue;
+        }
+
+        std::atomic<size_t> next{0};
+
+        auto worker = [&]() {
+            for (size_t i = next++; i < matches.size(); i = next++) {
+                MatchResult result = playMatch(matches[i]);
+
+                std::lock_guard<std::mutex> lock(resultMutex);
+                recordResult(result);
+                if (onResult) {
+                    onResult(result);
+                }
+            }
+        };
+
+        // Pairing for the next round needs every rating from this one, so the threads finish between rounds
+        int threadCount = std::min<int>(config.workers, static_cast<int>(matches.size()));
+        std::vector<std::thread> threads;
+        for (int t = 1; t < threadCount; ++t) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+}
+
+std::vector<Standing> MatchScheduler::standings() const
+{
+    std::vector<Standing> table;
+    for (size_t i = 0; i < libs.size(); ++i) {
+        table.push_back({static_cast<int>(i), libs[i], ratings[i], games[i], wins[i], peakHeaps[i]});
+    }
+    std::stable_sort(table.begin(), table.end(), [](const Standing& a, const Standing& b) {
+        return a.rating > b.rating;
+    });
+    return table;
+}
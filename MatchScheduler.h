@@ -0,0 +1,92 @@
+#ifndef MATCH_SCHEDULER_H
+#define MATCH_SCHEDULER_H
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Arena.h"
+#include "RobotRegistry.h"
+
+// How robots are grouped into games each round
+enum class PairingMode { RoundRobin, Swiss, Random };
+
+struct SchedulerConfig
+{
+    PairingMode mode = PairingMode::Swiss;
+    int groupSize = 4;     // robots per game
+    int rounds = 5;        // every robot plays once per round
+    int workers = 1;       // games run in parallel
+    int processes = 0;     // worker processes to play games in instead of threads (WorkerPool), 0 for none
+    std::string mapPath;   // the file behind arena.map, which is how worker processes find it
+    int gameTimeout = 300; // seconds a worker process gets for one game before it's killed, 0 for no limit
+    unsigned seed = 0;     // 0 picks a seed from the clock
+    ArenaConfig arena;     // template for every game, seed is filled in per game
+};
+
+// One scheduled game. Robots are indexes into the scheduler's library list.
+struct MatchSpec
+{
+    int id = 0;
+    int round = 0;
+    std::vector<int> robots;
+    unsigned seed = 0;
+};
+
+struct MatchResult
+{
+    MatchSpec match;
+    GameResult game; // slots in here are positions in match.robots
+};
+
+struct Standing
+{
+    int robot;
+    std::string library;
+    double rating;
+    int games;
+    int wins;
+    int64_t peakHeap; // most heap one of its robots held in any game, bytes (RobotMemory.h)
+};
+
+// Ranks a large pool of robot libraries by playing small groups against each other.
+// A pool of N robots needs about N / groupSize games per round instead of every robot in every game.
+// Libraries that fail validation are left out of the pairings.
+class WorkerPool;
+
+class MatchScheduler
+{
+public:
+    MatchScheduler(const std::vector<std::string>& robotLibs, const SchedulerConfig& config);
+    ~MatchScheduler();
+
+    // Plays every round. onResult is called (one at a time) as soon as each game finishes.
+    void run(const std::function<void(const MatchResult&)>& onResult);
+
+    std::vector<MatchSpec> pairRound(int round);
+    std::vector<Standing> standings() const;
+    RobotRegistry& robots() { return registry; }
+    const ArenaProfile& profile() const { return totalProfile; }
+
+private:
+    std::vector<std::string> libs;
+    RobotRegistry registry;
+    SchedulerConfig config;
+    std::mt19937 rng;
+    int nextMatchId = 0;
+
+    std::vector<double> ratings;
+    std::vector<int> games;
+    std::vector<int> wins;
+    std::vector<int64_t> peakHeaps;
+    ArenaProfile totalProfile;
+    std::mutex resultMutex;
+    std::unique_ptr<WorkerPool> pool; // started by the first round that needs it
+
+    std::vector<std::vector<int>> makeGroups(const std::vector<int>& order) const;
+    MatchResult playMatch(const MatchSpec& match);
+    void recordResult(const MatchResult& result);
+};
+
+#endif // MATCH_SCHEDULER_H
@@ -0,0 +1,184 @@
+#include "ObstacleLayout.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+struct MapHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t bitsPerCell;
+    int32_t rows;
+    int32_t cols;
+    uint64_t dataOffset;
+};
+
+constexpr char mapMagic[8] = { 'R', 'W', 'M', 'A', 'P', '\0', '\0', '\0' };
+
+} // namespace
+
+ObstacleLayout::ObstacleLayout(int rows, int cols)
+: numRows(rows), numCols(cols), storage(packedSize(rows, cols), 0)
+{
+    cells = storage.data();
+}
+
+ObstacleLayout ObstacleLayout::scatter(int rows, int cols, std::mt19937& rng)
+{
+    ObstacleLayout layout(rows, cols);
+    auto randomInt = [&](int low, int high) { return std::uniform_int_distribution<int>(low, high)(rng); };
+
+    long long numObstacles = static_cast<long long>(rows) * cols / 10;
+    for (long long i = 0; i < numObstacles; ++i)
+    {
+        int r = randomInt(0, rows - 1);
+        int c = randomInt(0, cols - 1);
+        if (layout.at(r, c) == EMPTY)
+        {
+            layout.set(r, c, static_cast<CellType>(randomInt(1, 3)));
+        }
+    }
+    return layout;
+}
+
+ObstacleLayout::ObstacleLayout(ObstacleLayout&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+ObstacleLayout& ObstacleLayout::operator=(ObstacleLayout&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (mapping)
+        {
+            munmap(mapping, mappingSize);
+        }
+        numRows = other.numRows;
+        numCols = other.numCols;
+        storage = std::move(other.storage);
+        mapping = other.mapping;
+        mappingSize = other.mappingSize;
+        cells = mapping ? other.cells : storage.data();
+        other.mapping = nullptr;
+        other.cells = nullptr;
+    }
+    return *this;
+}
+
+ObstacleLayout::~ObstacleLayout()
+{
+    if (mapping)
+    {
+        munmap(mapping, mappingSize);
+    }
+}
+
+void ObstacleLayout::set(int row, int col, CellType type)
+{
+    uint64_t index = static_cast<uint64_t>(row) * numCols + col;
+    uint8_t& byte = storage[index >> 2];
+    int shift = (index & 3) * 2;
+    byte = static_cast<uint8_t>((byte & ~(3 << shift)) | ((type & 3) << shift));
+}
+
+uint64_t ObstacleLayout::obstacleCount() const
+{
+    // Padding cells in the last byte are always zero, so they never count
+    uint64_t count = 0;
+    for (uint64_t byte = 0; byte < packedSize(numRows, numCols); ++byte)
+    {
+        // A cell is an obstacle if either of its bits is set
+        uint8_t bits = cells[byte];
+        count += __builtin_popcount((bits | (bits >> 1)) & 0x55);
+    }
+    return count;
+}
+
+bool ObstacleLayout::save(const std::string& path, std::string& error) const
+{
+    MapHeader header{};
+    std::memcpy(header.magic, mapMagic, sizeof(mapMagic));
+    header.version = VERSION;
+    header.bitsPerCell = BITS_PER_CELL;
+    header.rows = numRows;
+    header.cols = numCols;
+    header.dataOffset = sizeof(MapHeader);
+
+    // Truncating a file that's mapped MAP_SHARED elsewhere would take the pages out from under
+    // them (SIGBUS), so the new map goes in beside it and replaces it in one rename
+    std::string temporary = path + ".tmp";
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(cells), packedSize(numRows, numCols));
+    file.close();
+    if (file.fail() || std::rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temporary.c_str());
+        error = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<const ObstacleLayout> ObstacleLayout::map(const std::string& path, std::string& error)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        error = "cannot open " + path;
+        return nullptr;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(MapHeader))
+    {
+        close(fd);
+        error = path + " is not a map file";
+        return nullptr;
+    }
+
+    size_t size = static_cast<size_t>(info.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // the mapping keeps the file open
+    if (mapping == MAP_FAILED)
+    {
+        error = "cannot map " + path;
+        return nullptr;
+    }
+
+    MapHeader header;
+    std::memcpy(&header, mapping, sizeof(header));
+    std::string problem;
+    if (std::memcmp(header.magic, mapMagic, sizeof(mapMagic)) != 0)
+        problem = path + " is not a map file";
+    else if (header.version != VERSION)
+        problem = path + " is map version " + std::to_string(header.version);
+    else if (header.bitsPerCell != BITS_PER_CELL)
+        problem = path + " has " + std::to_string(header.bitsPerCell) + " bits per cell";
+    else if (header.rows <= 0 || header.cols <= 0 || header.dataOffset > size
+             || size - header.dataOffset < packedSize(header.rows, header.cols))
+        problem = path + " is truncated";
+
+    if (!problem.empty())
+    {
+        munmap(mapping, size);
+        error = problem;
+        return nullptr;
+    }
+
+    std::shared_ptr<ObstacleLayout> layout(new ObstacleLayout());
+    layout->numRows = header.rows;
+    layout->numCols = header.cols;
+    layout->mapping = mapping;
+    layout->mappingSize = size;
+    layout->cells = static_cast<const uint8_t*>(mapping) + header.dataOffset;
+    return layout;
+}
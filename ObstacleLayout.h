@@ -0,0 +1,80 @@
+#ifndef OBSTACLE_LAYOUT_H
+#define OBSTACLE_LAYOUT_H
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "Cell.h"
+
+// The static obstacles of a board (empty, flamethrower, pit, mound), packed 2 bits per cell.
+//
+// Layouts can be saved as map files and mapped back in with mmap: the packed cells in the file
+// are used where they lie, so opening even a huge map only reads the header, and every arena
+// (and every process) using the same map shares the same read-only pages.
+//
+// Map file, version 1, host byte order:
+//   char[8]  "RWMAP\0\0\0"
+//   uint32   version (1)
+//   uint32   bits per cell (2)
+//   int32    rows
+//   int32    cols
+//   uint64   offset of the cell data from the start of the file
+//   ...      cells, row-major, 4 to a byte, first cell in the low bits
+class ObstacleLayout
+{
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t BITS_PER_CELL = 2;
+
+    // All empty, for filling in with set()
+    ObstacleLayout(int rows, int cols);
+
+    // The original uniform scatter: about one cell in ten gets a random obstacle
+    static ObstacleLayout scatter(int rows, int cols, std::mt19937& rng);
+
+    // Map a file in read-only. Returns nullptr and sets error if it isn't a map file we can read.
+    static std::shared_ptr<const ObstacleLayout> map(const std::string& path, std::string& error);
+
+    // Writes a new file and renames it over path, so arenas with the old one mapped keep their pages
+    bool save(const std::string& path, std::string& error) const;
+
+    ObstacleLayout(const ObstacleLayout&) = delete;
+    ObstacleLayout& operator=(const ObstacleLayout&) = delete;
+    ObstacleLayout(ObstacleLayout&& other) noexcept;
+    ObstacleLayout& operator=(ObstacleLayout&& other) noexcept;
+    ~ObstacleLayout();
+
+    int rows() const { return numRows; }
+    int cols() const { return numCols; }
+
+    CellType at(int row, int col) const
+    {
+        uint64_t index = static_cast<uint64_t>(row) * numCols + col;
+        return static_cast<CellType>((cells[index >> 2] >> ((index & 3) * 2)) & 3);
+    }
+
+    // Only for layouts built in memory, mapped ones are read-only
+    void set(int row, int col, CellType type);
+
+    // Number of cells that aren't empty
+    uint64_t obstacleCount() const;
+
+private:
+    ObstacleLayout() = default;
+
+    static uint64_t packedSize(int rows, int cols)
+    {
+        return (static_cast<uint64_t>(rows) * cols + 3) / 4;
+    }
+
+    int numRows = 0;
+    int numCols = 0;
+    const uint8_t* cells = nullptr; // into storage or into the mapping
+    std::vector<uint8_t> storage;
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+};
+
+#endif // OBSTACLE_LAYOUT_H
@@ -0,0 +1,115 @@
+#include "RadarCache.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+
+// The line a radar direction runs along, as in Arena::getNextCell
+constexpr int lineKinds[9] = { -1, 1, 2, 0, 3, 1, 2, 0, 3 };
+
+} // namespace
+
+RadarCache::RadarCache(int cols)
+: cols(cols)
+{
+}
+
+// Kind in the top bits, then which row, column or diagonal
+uint64_t RadarCache::line(LineKind kind, int row, int col) const
+{
+    int64_t index = kind == ROW_LINE      ? row
+                  : kind == COL_LINE      ? col
+                  : kind == ANTI_DIAGONAL ? static_cast<int64_t>(row) + col
+                                          : static_cast<int64_t>(row) - col + cols;
+    return static_cast<uint64_t>(kind) << 56 | static_cast<uint64_t>(index);
+}
+
+const std::vector<RadarObj>& RadarCache::store(int row, int col, int direction, const std::vector<RadarObj>& results)
+{
+    if (entries.size() >= MAX_ENTRIES)
+    {
+        clear();
+    }
+
+    uint64_t ray = key(row, col, direction);
+    Entry& entry = entries[ray];
+    entry.results.assign(results.begin(), results.end());
+    entry.stamp = ++nextStamp;
+    entry.valid = true;
+
+    // One watch per unbroken stretch. Off an edge a row or column starts again at the other end and a
+    // diagonal jumps to another, so a new stretch starts wherever the line or position jumps
+    LineKind kind = static_cast<LineKind>(lineKinds[direction]);
+    size_t start = 0;
+    uint64_t prevLine = 0;
+    int prevPosition = 0;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        uint64_t at = line(kind, results[i].m_row, results[i].m_col);
+        int pos = position(kind, results[i].m_row, results[i].m_col);
+        if (i > 0 && (at != prevLine || std::abs(pos - prevPosition) != 1))
+        {
+            watch(kind, results[start], results[i - 1], ray, entry.stamp);
+            start = i;
+        }
+        prevLine = at;
+        prevPosition = pos;
+    }
+    if (!results.empty())
+    {
+        watch(kind, results[start], results.back(), ray, entry.stamp);
+    }
+    return entry.results;
+}
+
+// Anything the ray left on the line from an older store goes first, so lists don't grow
+void RadarCache::watch(LineKind kind, const RadarObj& first, const RadarObj& last, uint64_t ray, uint32_t stamp)
+{
+    std::vector<Watch>& watches = lines[line(kind, first.m_row, first.m_col)];
+    watches.erase(std::remove_if(watches.begin(), watches.end(),
+                                 [&](const Watch& w) { return w.ray == ray && w.stamp != stamp; }),
+                  watches.end());
+    int from = position(kind, first.m_row, first.m_col);
+    int to = position(kind, last.m_row, last.m_col);
+    watches.push_back(Watch{ray, stamp, std::min(from, to), std::max(from, to)});
+}
+
+int RadarCache::cellChanged(int row, int col)
+{
+    int dropped = 0;
+    for (LineKind kind : { ROW_LINE, COL_LINE, ANTI_DIAGONAL, DIAGONAL })
+    {
+        auto it = lines.find(line(kind, row, col));
+        if (it == lines.end())
+        {
+            continue;
+        }
+
+        int at = position(kind, row, col);
+        std::vector<Watch>& watches = it->second;
+        for (size_t i = 0; i < watches.size();)
+        {
+            if (at < watches[i].from || at > watches[i].to)
+            {
+                ++i;
+                continue;
+            }
+            Entry& entry = entries[watches[i].ray];
+            if (entry.valid && entry.stamp == watches[i].stamp)
+            {
+                entry.valid = false;
+                ++dropped;
+            }
+            watches[i] = watches.back();
+            watches.pop_back();
+        }
+    }
+    return dropped;
+}
+
+void RadarCache::clear()
+{
+    entries.clear();
+    lines.clear();
+}
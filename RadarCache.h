@@ -0,0 +1,79 @@
+#ifndef RADAR_CACHE_H
+#define RADAR_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "RadarObj.h"
+
+// Radar results by (origin, direction), so a robot that scans the same way from the same cell
+// turn after turn gets the last answer back instead of a fresh walk down the ray.
+//
+// A cached ray is only thrown away when one of the cells it covers changes type. A ray runs along
+// one line of the board (a row, a column or a diagonal) until it wraps round an edge, so it is a
+// few unbroken stretches of lines. Each line keeps the stretches cached along it, and a change
+// looks at the four lines through its cell rather than every cell of every ray keeping a list.
+// Arena::setCellType hands every change in here: robots moving, dying and falling in pits all
+// come through there.
+//
+// Entries and watch lists keep their memory once a game is under way. Past MAX_ENTRIES rays
+// the whole cache starts over rather than let a long game on a big board grow it for ever.
+class RadarCache
+{
+public:
+    static constexpr size_t MAX_ENTRIES = 4096;
+
+    explicit RadarCache(int cols);
+
+    // The cached ray, or null if there isn't a valid one. direction is 1-8, as in RobotBase.h.
+    const std::vector<RadarObj>* find(int row, int col, int direction) const
+    {
+        auto it = entries.find(key(row, col, direction));
+        return it != entries.end() && it->second.valid ? &it->second.results : nullptr;
+    }
+
+    // Keep a freshly walked ray, every cell it reached being in results. Returns the cached copy.
+    const std::vector<RadarObj>& store(int row, int col, int direction, const std::vector<RadarObj>& results);
+
+    // Call after the type of a cell changes. Returns how many cached rays that threw away.
+    int cellChanged(int row, int col);
+
+    // Forget everything, for after bulk changes like placing all the obstacles
+    void clear();
+
+    size_t size() const { return entries.size(); }
+
+private:
+    struct Entry
+    {
+        std::vector<RadarObj> results;
+        uint32_t stamp = 0; // which store this is, so watches left from an older one are ignored
+        bool valid = false;
+    };
+
+    // A stretch of a line a ray covers, from and to being positions along it
+    struct Watch
+    {
+        uint64_t ray;
+        uint32_t stamp;
+        int from, to;
+    };
+
+    enum LineKind { ROW_LINE, COL_LINE, ANTI_DIAGONAL, DIAGONAL };
+
+    uint64_t key(int row, int col, int direction) const
+    {
+        return (static_cast<uint64_t>(row) * cols + col) * 8 + (direction - 1);
+    }
+    uint64_t line(LineKind kind, int row, int col) const;
+    static int position(LineKind kind, int row, int col) { return kind == ROW_LINE ? col : row; }
+    void watch(LineKind kind, const RadarObj& first, const RadarObj& last, uint64_t ray, uint32_t stamp);
+
+    int cols;
+    uint32_t nextStamp = 0;
+    std::unordered_map<uint64_t, Entry> entries;            // by key()
+    std::unordered_map<uint64_t, std::vector<Watch>> lines; // by line()
+};
+
+#endif // RADAR_CACHE_H
@@ -0,0 +1,20 @@
+#ifndef ROBOT_CONFIG_H
+#define ROBOT_CONFIG_H
+
+#include "RobotBase.h"
+
+// The build a robot gets from RobotBase's constructor, as something a tuner can vary (RobotTuner.h).
+// RobotBase clamps move to 2-5 and armor to 7 - move, so every config here is one it accepts.
+struct RobotConfig
+{
+    int move = 2;
+    int armor = 0;
+    WeaponType weapon = flamethrower;
+};
+
+// Optional library export, found with dlsym like the checkpoint hooks:
+//   extern "C" RobotBase* create_robot_with_config(const RobotConfig* config)
+// builds the library's robot with the given move, armor and weapon instead of its own choice.
+typedef RobotBase* (*RobotConfigFactory)(const RobotConfig* config);
+
+#endif // ROBOT_CONFIG_H
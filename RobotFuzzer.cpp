@@ -0,0 +1,542 @@
+#include "RobotFuzzer.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <new>
+#include <poll.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+
+enum FuzzCall { CREATE, RADAR_DIRECTION, PROCESS_RADAR, SHOT_LOCATION, MOVE_DIRECTION, DESTROY, CALL_COUNT };
+
+const char* callNames[CALL_COUNT] =
+{
+    "create_robot", "get_radar_direction", "process_radar_results", "get_shot_location",
+    "get_move_direction", "delete"
+};
+
+enum Violation { BAD_RADAR_DIRECTION, BAD_MOVE_DIRECTION, BAD_MOVE_DISTANCE, SHOT_OFF_BOARD, SLOW_CALL, NULL_ROBOT, VIOLATION_COUNT };
+
+const char* violationNames[VIOLATION_COUNT] =
+{
+    "radar direction outside 0-8", "move direction outside 0-8", "negative move distance",
+    "shot outside the board", "slow call", "create_robot returned null"
+};
+
+constexpr int EXAMPLES_KEPT = 3;
+constexpr double WARM_UP_SHARE = 0.2; // memory growth is measured from this far into the run
+constexpr int GAMES_PER_MEMORY_SAMPLE = 64;
+
+// Where the child is, in memory shared with the parent, so a crash or hang can be pinned on a game
+struct FuzzProgress
+{
+    std::atomic<uint64_t> games;
+    std::atomic<uint64_t> calls;
+    std::atomic<int64_t> callStarted; // steady clock nanoseconds, 0 between calls
+    std::atomic<int> call;
+    std::atomic<unsigned> seed;
+    std::atomic<int> rows, cols, turn;
+};
+
+int64_t nowNanos()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t residentBytes()
+{
+    long pages = 0, resident = 0;
+    FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (statm)
+    {
+        if (std::fscanf(statm, "%ld %ld", &pages, &resident) != 2)
+        {
+            resident = 0;
+        }
+        std::fclose(statm);
+    }
+    return static_cast<int64_t>(resident) * sysconf(_SC_PAGESIZE);
+}
+
+// Log scale latency counts: four buckets per power of two, exact below 16ns
+class LatencyHistogram
+{
+public:
+    void add(uint64_t nanos)
+    {
+        ++counts[bucket(nanos)];
+        ++total;
+        worst = std::max(worst, nanos);
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t max() const { return worst; }
+
+    // Lower edge of the bucket the quantile falls in
+    uint64_t percentile(double p) const
+    {
+        uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(total));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i)
+        {
+            seen += counts[i];
+            if (seen > rank)
+            {
+                return lowerEdge(i);
+            }
+        }
+        return worst;
+    }
+
+private:
+    static constexpr size_t BUCKETS = 16 + 60 * 4;
+
+    static size_t bucket(uint64_t nanos)
+    {
+        if (nanos < 16)
+        {
+            return nanos;
+        }
+        int power = std::bit_width(nanos) - 1;
+        return 16 + (power - 4) * 4 + ((nanos >> (power - 2)) & 3);
+    }
+
+    static uint64_t lowerEdge(size_t index)
+    {
+        if (index < 16)
+        {
+            return index;
+        }
+        int power = static_cast<int>(index - 16) / 4 + 4;
+        return (4 + (index - 16) % 4) << (power - 2);
+    }
+
+    uint64_t counts[BUCKETS] = {};
+    uint64_t total = 0;
+    uint64_t worst = 0;
+};
+
+// The child's side: play games until the time is up and describe what happened
+class Fuzzer
+{
+public:
+    Fuzzer(RobotFactory factory, const FuzzConfig& config, FuzzProgress& progress)
+    : factory(factory), config(config), progress(progress) {}
+
+    void run();
+    std::string report() const;
+    bool clean() const;
+
+private:
+    RobotFactory factory;
+    const FuzzConfig& config;
+    FuzzProgress& progress;
+    std::mt19937 rng;
+    unsigned seed = 0;
+    int rows = 0, cols = 0, turn = 0;
+
+    LatencyHistogram latency[CALL_COUNT];
+    uint64_t violations[VIOLATION_COUNT] = {};
+    std::vector<std::string> examples[VIOLATION_COUNT];
+    uint64_t games = 0, turns = 0;
+    double elapsedSeconds = 0;
+    int64_t warmBytes = -1, finalBytes = 0, peakBytes = 0;
+
+    template <typename F>
+    auto timed(FuzzCall call, F&& body);
+    void flag(Violation violation, const std::string& detail);
+    int randomInt(int low, int high) { return std::uniform_int_distribution<int>(low, high)(rng); }
+    bool chance(double p) { return std::uniform_real_distribution<double>(0.0, 1.0)(rng) < p; }
+    int boardSize();
+    void radarResults(std::vector<RadarObj>& results, int row, int col, int direction);
+    void playGame();
+};
+
+// Run one call to the robot, timing it and letting the parent see it's under way
+template <typename F>
+auto Fuzzer::timed(FuzzCall call, F&& body)
+{
+    progress.call.store(call, std::memory_order_relaxed);
+    int64_t start = nowNanos();
+    progress.callStarted.store(start, std::memory_order_relaxed);
+
+    struct Finish
+    {
+        Fuzzer& fuzzer;
+        FuzzCall call;
+        int64_t start;
+        ~Finish()
+        {
+            int64_t took = nowNanos() - start;
+            fuzzer.progress.callStarted.store(0, std::memory_order_relaxed);
+            fuzzer.progress.calls.fetch_add(1, std::memory_order_relaxed);
+            fuzzer.latency[call].add(static_cast<uint64_t>(took));
+            if (took > fuzzer.config.slowNanos)
+            {
+                fuzzer.flag(SLOW_CALL, std::string(callNames[call]) + " took " + std::to_string(took / 1000) + "us");
+            }
+        }
+    } finish{*this, call, start};
+    return body();
+}
+
+void Fuzzer::flag(Violation violation, const std::string& detail)
+{
+    if (violations[violation]++ < EXAMPLES_KEPT)
+    {
+        examples[violation].push_back(detail + " (seed " + std::to_string(seed) + ", " + std::to_string(rows) + "x"
+                                      + std::to_string(cols) + ", turn " + std::to_string(turn) + ")");
+    }
+}
+
+// Mostly arena sized boards, some big ones, and the odd degenerate one
+int Fuzzer::boardSize()
+{
+    double pick = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+    if (pick < 0.05) return randomInt(1, 3);
+    if (pick < 0.6)  return randomInt(std::min(4, config.maxBoard), std::min(20, config.maxBoard));
+    if (pick < 0.9)  return randomInt(1, std::min(200, config.maxBoard));
+    return randomInt(1, config.maxBoard);
+}
+
+// What the arena's radar would see looking that way, over a made up board: a ray of random cells
+// that stops at the first robot, mound or wreck. Now and then some of it is junk from anywhere.
+void Fuzzer::radarResults(std::vector<RadarObj>& results, int row, int col, int direction)
+{
+    static const char types[] = { '.', '.', '.', '.', '.', 'R', 'M', 'P', 'F', 'X' };
+    results.clear();
+    if (direction >= 1 && direction <= 8)
+    {
+        int r = row + directions[direction].first;
+        int c = col + directions[direction].second;
+        while (r >= 0 && r < rows && c >= 0 && c < cols)
+        {
+            char type = types[randomInt(0, static_cast<int>(sizeof(types)) - 1)];
+            results.emplace_back(type, r, c);
+            if (type == 'R' || type == 'M' || type == 'X')
+            {
+                break;
+            }
+            r += directions[direction].first;
+            c += directions[direction].second;
+        }
+    }
+    if (chance(0.1))
+    {
+        for (int i = randomInt(1, 8); i > 0; --i)
+        {
+            results.emplace_back(types[randomInt(5, static_cast<int>(sizeof(types)) - 1)], randomInt(0, rows - 1), randomInt(0, cols - 1));
+        }
+    }
+}
+
+void Fuzzer::playGame()
+{
+    rows = boardSize();
+    cols = boardSize();
+    turn = 0;
+    progress.seed.store(seed, std::memory_order_relaxed);
+    progress.rows.store(rows, std::memory_order_relaxed);
+    progress.cols.store(cols, std::memory_order_relaxed);
+    progress.turn.store(0, std::memory_order_relaxed);
+
+    RobotBase* robot = timed(CREATE, [&] { return factory(); });
+    if (!robot)
+    {
+        flag(NULL_ROBOT, "no robot");
+        return;
+    }
+    robot->set_boundaries(rows, cols);
+    robot->move_to(randomInt(0, rows - 1), randomInt(0, cols - 1));
+
+    std::vector<RadarObj> radar;
+    int turnCount = randomInt(1, 200);
+    for (turn = 1; turn <= turnCount && robot->get_health() > 0; ++turn)
+    {
+        progress.turn.store(turn, std::memory_order_relaxed);
+        ++turns;
+
+        int radarDirection = 0;
+        timed(RADAR_DIRECTION, [&] { robot->get_radar_direction(radarDirection); });
+        if (radarDirection < 0 || radarDirection > 8)
+        {
+            flag(BAD_RADAR_DIRECTION, "direction " + std::to_string(radarDirection));
+        }
+
+        int row, col;
+        robot->get_current_location(row, col);
+        radarResults(radar, row, col, radarDirection);
+        timed(PROCESS_RADAR, [&] { robot->process_radar_results(radar); });
+
+        int shotRow = 0, shotCol = 0;
+        if (timed(SHOT_LOCATION, [&] { return robot->get_shot_location(shotRow, shotCol); }))
+        {
+            if (shotRow < 0 || shotRow >= rows || shotCol < 0 || shotCol >= cols)
+            {
+                flag(SHOT_OFF_BOARD, "shot at (" + std::to_string(shotRow) + ", " + std::to_string(shotCol) + ")");
+            }
+        }
+        else
+        {
+            int direction = 0, distance = 0;
+            timed(MOVE_DIRECTION, [&] { robot->get_move_direction(direction, distance); });
+            if (direction < 0 || direction > 8)
+            {
+                flag(BAD_MOVE_DIRECTION, "direction " + std::to_string(direction));
+            }
+            else if (distance < 0)
+            {
+                flag(BAD_MOVE_DISTANCE, "distance " + std::to_string(distance));
+            }
+            else if (direction > 0 && robot->get_move_speed() > 0)
+            {
+                // Like the arena, minus the obstacles: capped at the robot's speed and the board's edge
+                distance = std::min(distance, robot->get_move_speed());
+                robot->move_to(std::clamp(row + directions[direction].first * distance, 0, rows - 1),
+                               std::clamp(col + directions[direction].second * distance, 0, cols - 1));
+            }
+        }
+
+        // The rest of the board happening to it
+        if (chance(0.05))
+        {
+            robot->take_damage(randomInt(10, 40));
+        }
+        if (chance(0.01))
+        {
+            robot->disable_movement();
+        }
+    }
+
+    timed(DESTROY, [&] { delete robot; });
+}
+
+void Fuzzer::run()
+{
+    int64_t start = nowNanos();
+    int64_t warmAt = start + static_cast<int64_t>(config.seconds * WARM_UP_SHARE * 1e9);
+    int64_t end = start + static_cast<int64_t>(config.seconds * 1e9);
+    int64_t now = start;
+
+    for (; now < end; now = nowNanos())
+    {
+        seed = config.seed + static_cast<unsigned>(games);
+        rng.seed(seed);
+        playGame();
+        progress.games.store(++games, std::memory_order_relaxed);
+
+        if (games % GAMES_PER_MEMORY_SAMPLE == 0)
+        {
+            int64_t bytes = residentBytes();
+            peakBytes = std::max(peakBytes, bytes);
+            if (warmBytes < 0 && now >= warmAt)
+            {
+                warmBytes = bytes;
+            }
+        }
+    }
+    elapsedSeconds = static_cast<double>(now - start) / 1e9;
+    finalBytes = residentBytes();
+    peakBytes = std::max(peakBytes, finalBytes);
+    if (warmBytes < 0)
+    {
+        warmBytes = finalBytes;
+    }
+}
+
+bool Fuzzer::clean() const
+{
+    for (uint64_t count : violations)
+    {
+        if (count > 0)
+        {
+            return false;
+        }
+    }
+    return finalBytes - warmBytes <= config.maxGrowthMB * 1024 * 1024;
+}
+
+std::string Fuzzer::report() const
+{
+    std::ostringstream out;
+    uint64_t calls = 0;
+    for (const LatencyHistogram& histogram : latency)
+    {
+        calls += histogram.count();
+    }
+    out << games << " games, " << turns << " turns, " << calls << " calls in " << elapsedSeconds << "s ("
+        << static_cast<long long>(calls / std::max(elapsedSeconds, 1e-9) * 60) << " calls per minute)\n\n";
+
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-24s%12s%10s%10s%10s%10s%12s\n", "latency (ns)", "calls", "p50", "p90", "p99",
+                  "p99.9", "max");
+    out << line;
+    for (int call = 0; call < CALL_COUNT; ++call)
+    {
+        const LatencyHistogram& h = latency[call];
+        std::snprintf(line, sizeof(line), "%-24s%12llu%10llu%10llu%10llu%10llu%12llu\n", callNames[call],
+                      static_cast<unsigned long long>(h.count()), static_cast<unsigned long long>(h.percentile(0.5)),
+                      static_cast<unsigned long long>(h.percentile(0.9)), static_cast<unsigned long long>(h.percentile(0.99)),
+                      static_cast<unsigned long long>(h.percentile(0.999)), static_cast<unsigned long long>(h.max()));
+        out << line;
+    }
+
+    double megabyte = 1024.0 * 1024.0;
+    out << "\nresident memory: " << warmBytes / megabyte << " MB after warm up, " << finalBytes / megabyte
+        << " MB at the end, " << peakBytes / megabyte << " MB peak\n";
+    if (finalBytes - warmBytes > config.maxGrowthMB * 1024 * 1024)
+    {
+        out << "Error: memory grew " << (finalBytes - warmBytes) / megabyte << " MB after warm up, the robot is leaking\n";
+    }
+
+    for (int v = 0; v < VIOLATION_COUNT; ++v)
+    {
+        if (violations[v] == 0)
+        {
+            continue;
+        }
+        out << "Error: " << violations[v] << " x " << violationNames[v] << "\n";
+        for (const std::string& example : examples[v])
+        {
+            out << "    " << example << "\n";
+        }
+    }
+    return out.str();
+}
+
+// The parent's side: what the child was doing when it went down
+std::string whereItWas(const FuzzProgress& progress)
+{
+    int call = progress.call.load();
+    return std::string("in ") + callNames[call >= 0 && call < CALL_COUNT ? call : 0] + ", game "
+           + std::to_string(progress.games.load()) + " (seed " + std::to_string(progress.seed.load()) + ", "
+           + std::to_string(progress.rows.load()) + "x" + std::to_string(progress.cols.load()) + ", turn "
+           + std::to_string(progress.turn.load()) + ") after " + std::to_string(progress.calls.load()) + " calls";
+}
+
+} // namespace
+
+int fuzzRobot(RobotFactory factory, const FuzzConfig& config)
+{
+    FuzzConfig settings = config;
+    if (settings.seed == 0)
+    {
+        settings.seed = static_cast<unsigned>(std::time(nullptr));
+    }
+    settings.maxBoard = std::max(1, settings.maxBoard);
+    std::cout << "Fuzzing for " << settings.seconds << "s from seed " << settings.seed << "...\n" << std::flush;
+
+    void* shared = mmap(nullptr, sizeof(FuzzProgress), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    int fds[2];
+    if (shared == MAP_FAILED || pipe(fds) != 0)
+    {
+        std::cerr << "Cannot set up the fuzzer: " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    FuzzProgress* progress = new (shared) FuzzProgress();
+
+    pid_t child = fork();
+    if (child < 0)
+    {
+        std::cerr << "Cannot fork the fuzzer: " << std::strerror(errno) << "\n";
+        return 1;
+    }
+
+    if (child == 0)
+    {
+        close(fds[0]);
+        // Robots talk a lot; keep it out of the report
+        int devnull = open("/dev/null", O_WRONLY);
+        if (devnull >= 0)
+        {
+            dup2(devnull, STDOUT_FILENO);
+            close(devnull);
+        }
+        rlimit limit{};
+        limit.rlim_cur = limit.rlim_max = static_cast<rlim_t>(settings.memoryLimitMB) * 1024 * 1024;
+        setrlimit(RLIMIT_AS, &limit);
+
+        Fuzzer fuzzer(factory, settings, *progress);
+        fuzzer.run();
+        std::string text = fuzzer.report();
+        for (size_t written = 0; written < text.size(); )
+        {
+            ssize_t n = write(fds[1], text.data() + written, text.size() - written);
+            if (n <= 0)
+            {
+                break;
+            }
+            written += static_cast<size_t>(n);
+        }
+        _exit(fuzzer.clean() ? 0 : 1);
+    }
+
+    // Collect the report, watching for a call that never comes back
+    close(fds[1]);
+    std::string text;
+    bool hung = false;
+    char buffer[4096];
+    for (;;)
+    {
+        pollfd fd{fds[0], POLLIN, 0};
+        if (poll(&fd, 1, 50) > 0)
+        {
+            ssize_t n = read(fds[0], buffer, sizeof(buffer));
+            if (n <= 0)
+            {
+                break;
+            }
+            text.append(buffer, static_cast<size_t>(n));
+            continue;
+        }
+        int64_t started = progress->callStarted.load();
+        if (started != 0 && nowNanos() - started > settings.hangMillis * 1000000)
+        {
+            hung = true;
+            kill(child, SIGKILL);
+            break;
+        }
+    }
+    close(fds[0]);
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    int result = 0;
+    std::cout << text;
+    if (hung)
+    {
+        std::cerr << "Error: no answer for " << settings.hangMillis << "ms " << whereItWas(*progress) << "\n";
+        result = 1;
+    }
+    else if (WIFSIGNALED(status))
+    {
+        std::cerr << "Error: crashed with " << strsignal(WTERMSIG(status)) << " " << whereItWas(*progress) << "\n";
+        result = 1;
+    }
+    else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        result = 1;
+    }
+
+    progress->~FuzzProgress();
+    munmap(shared, sizeof(FuzzProgress));
+    std::cout << (result == 0 ? "Fuzzing passed.\n" : "Fuzzing failed.\n");
+    return result;
+}
@@ -0,0 +1,34 @@
+#ifndef ROBOT_FUZZER_H
+#define ROBOT_FUZZER_H
+
+#include <cstdint>
+#include "RobotBase.h"
+
+struct FuzzConfig
+{
+    double seconds = 10;            // how long to keep going
+    unsigned seed = 0;              // 0 picks a seed from the clock
+    int maxBoard = 5000;            // boards go up to this many rows and columns
+    int64_t slowNanos = 10000000;   // calls slower than this get reported
+    int64_t hangMillis = 2000;      // a call this slow is a hang and ends the run
+    int64_t memoryLimitMB = 4096;   // address space for the robot, so runaway allocation fails instead of swapping
+    int64_t maxGrowthMB = 16;       // resident memory growth after warm up that counts as a leak
+};
+
+// Throws randomized games at a robot as fast as it will take them: fresh instances on boards of
+// every size, radar results along the direction it asked for (and now and then junk anywhere on
+// the board), damage and pits at random. Every answer is checked against what the arena accepts:
+//   - radar and move directions in 0-8, move distances not negative
+//   - shots inside the board
+//   - no call slower than slowNanos, none hanging past hangMillis
+//   - resident memory not growing once the robot has warmed up
+// and every call is timed for latency percentiles.
+//
+// The robot runs in a child process, so a crash or a hang is caught and reported with the game
+// it happened in rather than taking the tester down. Games are seeded seed, seed + 1, ... but
+// robots that use rand() will not replay exactly.
+//
+// Prints a report to stdout and returns 0 if the robot came through clean.
+int fuzzRobot(RobotFactory factory, const FuzzConfig& config);
+
+#endif // ROBOT_FUZZER_H
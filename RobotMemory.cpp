@@ -0,0 +1,218 @@
+#include "RobotMemory.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+class MemoryAccount
+{
+public:
+    std::atomic<int64_t> live{0};
+    std::atomic<int64_t> peak{0};
+    std::atomic<int64_t> refs{1}; // blocks charged to it, plus one for its owner
+    std::atomic<bool> over{false};
+    int64_t cap = 0;
+};
+
+namespace
+{
+
+thread_local MemoryAccount* current = nullptr;
+
+// In front of every block. Its size keeps a plain new's blocks as aligned as malloc's.
+struct BlockHeader
+{
+    MemoryAccount* account;
+    uint64_t size;
+};
+static_assert(sizeof(BlockHeader) == 16 && alignof(std::max_align_t) <= sizeof(BlockHeader));
+
+// Accounts are malloc'ed, not new'ed, so they don't come through here themselves
+void release(MemoryAccount* account)
+{
+    if (account->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        account->~MemoryAccount();
+        std::free(account);
+    }
+}
+
+void charge(MemoryAccount* account, int64_t size)
+{
+    account->refs.fetch_add(1, std::memory_order_relaxed);
+    int64_t live = account->live.fetch_add(size, std::memory_order_relaxed) + size;
+    int64_t peak = account->peak.load(std::memory_order_relaxed);
+    while (live > peak && !account->peak.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+    {
+    }
+    if (account->cap > 0 && live > account->cap)
+    {
+        account->over.store(true, std::memory_order_relaxed);
+    }
+}
+
+// Bytes from the start of the block to what the caller gets: the header, or more to keep an
+// over-aligned block aligned
+std::size_t headerRoom(std::size_t alignment)
+{
+    return alignment > sizeof(BlockHeader) ? alignment : sizeof(BlockHeader);
+}
+
+void* allocate(std::size_t size, std::size_t alignment) noexcept
+{
+    std::size_t room = headerRoom(alignment);
+    if (size > SIZE_MAX - 2 * room)
+    {
+        return nullptr;
+    }
+    void* base = room > sizeof(BlockHeader)
+        ? std::aligned_alloc(alignment, (size + room + alignment - 1) / alignment * alignment)
+        : std::malloc(size + room);
+    if (!base)
+    {
+        return nullptr;
+    }
+
+    char* block = static_cast<char*>(base) + room;
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(block) - 1;
+    header->account = current;
+    header->size = size;
+    if (current)
+    {
+        charge(current, static_cast<int64_t>(size));
+    }
+    return block;
+}
+
+void deallocate(void* block, std::size_t alignment) noexcept
+{
+    if (!block)
+    {
+        return;
+    }
+    BlockHeader* header = static_cast<BlockHeader*>(block) - 1;
+    if (header->account)
+    {
+        header->account->live.fetch_sub(static_cast<int64_t>(header->size), std::memory_order_relaxed);
+        release(header->account);
+    }
+    std::free(static_cast<char*>(block) - headerRoom(alignment));
+}
+
+// What the standard asks of operator new: try the new_handler until it gives up
+void* allocateOrThrow(std::size_t size, std::size_t alignment)
+{
+    while (true)
+    {
+        if (void* block = allocate(size, alignment))
+        {
+            return block;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+        {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* allocateOrNull(std::size_t size, std::size_t alignment) noexcept
+{
+    try
+    {
+        return allocateOrThrow(size, alignment);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+constexpr std::size_t plain = alignof(std::max_align_t);
+
+} // namespace
+
+MemoryAccount* openMemoryAccount(int64_t cap)
+{
+    void* raw = std::malloc(sizeof(MemoryAccount));
+    if (!raw)
+    {
+        throw std::bad_alloc();
+    }
+    MemoryAccount* account = new (raw) MemoryAccount;
+    account->cap = cap;
+    return account;
+}
+
+void closeMemoryAccount(MemoryAccount* account)
+{
+    if (account)
+    {
+        release(account);
+    }
+}
+
+RobotMemoryUse memoryUse(const MemoryAccount* account)
+{
+    RobotMemoryUse use;
+    if (account)
+    {
+        use.peak = account->peak.load(std::memory_order_relaxed);
+        use.live = account->live.load(std::memory_order_relaxed);
+        use.overCap = account->over.load(std::memory_order_relaxed);
+    }
+    return use;
+}
+
+bool overMemoryCap(const MemoryAccount* account)
+{
+    return account && account->over.load(std::memory_order_relaxed);
+}
+
+MemoryScope::MemoryScope(MemoryAccount* account)
+: previous(current)
+{
+    current = account;
+}
+
+MemoryScope::~MemoryScope()
+{
+    current = previous;
+}
+
+// The replacements. Every form ends up in allocate and deallocate, so a block can go out through
+// any delete that matches the new it came from.
+void* operator new(std::size_t size) { return allocateOrThrow(size, plain); }
+void* operator new[](std::size_t size) { return allocateOrThrow(size, plain); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocateOrNull(size, plain); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocateOrNull(size, plain); }
+void* operator new(std::size_t size, std::align_val_t al) { return allocateOrThrow(size, static_cast<std::size_t>(al)); }
+void* operator new[](std::size_t size, std::align_val_t al) { return allocateOrThrow(size, static_cast<std::size_t>(al)); }
+void* operator new(std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+    return allocateOrNull(size, static_cast<std::size_t>(al));
+}
+void* operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+    return allocateOrNull(size, static_cast<std::size_t>(al));
+}
+
+void operator delete(void* block) noexcept { deallocate(block, plain); }
+void operator delete[](void* block) noexcept { deallocate(block, plain); }
+void operator delete(void* block, std::size_t) noexcept { deallocate(block, plain); }
+void operator delete[](void* block, std::size_t) noexcept { deallocate(block, plain); }
+void operator delete(void* block, const std::nothrow_t&) noexcept { deallocate(block, plain); }
+void operator delete[](void* block, const std::nothrow_t&) noexcept { deallocate(block, plain); }
+void operator delete(void* block, std::align_val_t al) noexcept { deallocate(block, static_cast<std::size_t>(al)); }
+void operator delete[](void* block, std::align_val_t al) noexcept { deallocate(block, static_cast<std::size_t>(al)); }
+void operator delete(void* block, std::size_t, std::align_val_t al) noexcept { deallocate(block, static_cast<std::size_t>(al)); }
+void operator delete[](void* block, std::size_t, std::align_val_t al) noexcept { deallocate(block, static_cast<std::size_t>(al)); }
+void operator delete(void* block, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+    deallocate(block, static_cast<std::size_t>(al));
+}
+void operator delete[](void* block, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+    deallocate(block, static_cast<std::size_t>(al));
+}
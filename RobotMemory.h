@@ -0,0 +1,49 @@
+#ifndef ROBOT_MEMORY_H
+#define ROBOT_MEMORY_H
+
+#include <cstdint>
+
+// Heap use per robot. Robots are whatever C++ a library brings, and one that never lets go of
+// anything can take a long tournament down with it, so the arena keeps an account per robot and
+// charges it for what gets allocated while the robot's code is running.
+//
+// The program replaces the global operator new and delete (RobotMemory.cpp), which the robot
+// libraries bind to as well. Every block carries a small header naming the account it was
+// charged to, so it's credited back to that robot whoever frees it and whenever. Blocks
+// allocated outside a MemoryScope belong to no one and cost a thread-local read.
+//
+// Robots allocating with malloc directly aren't seen.
+class MemoryAccount;
+
+struct RobotMemoryUse
+{
+    int64_t peak = 0;     // most heap the robot held at once, bytes
+    int64_t live = 0;     // what it held at the end; for a dead robot, what its destructor left behind
+    bool overCap = false; // went over the arena's memoryCap
+};
+
+// cap is in bytes, 0 for none. Going over it is noted, not refused: the arena decides what
+// happens to the robot once its callback returns.
+MemoryAccount* openMemoryAccount(int64_t cap);
+
+// The owner is done with it. Blocks still charged to it keep it alive until they're freed.
+// Null is fine.
+void closeMemoryAccount(MemoryAccount* account);
+
+RobotMemoryUse memoryUse(const MemoryAccount* account); // all zero for null
+bool overMemoryCap(const MemoryAccount* account);
+
+// Charges allocations on this thread to an account while in scope. Scopes nest.
+class MemoryScope
+{
+public:
+    explicit MemoryScope(MemoryAccount* account);
+    ~MemoryScope();
+    MemoryScope(const MemoryScope&) = delete;
+    MemoryScope& operator=(const MemoryScope&) = delete;
+
+private:
+    MemoryAccount* previous;
+};
+
+#endif // ROBOT_MEMORY_H
@@ -0,0 +1,211 @@
+#include "RobotRegistry.h"
+#include <dlfcn.h>
+#include <unistd.h>
+#include <filesystem>
+#include <iostream>
+
+RobotLibrary::RobotLibrary(const std::string& path, void* handle, RobotFactory factory)
+: libPath(path), handle(handle), factory(factory)
+{
+}
+
+RobotLibrary::~RobotLibrary()
+{
+    dlclose(handle);
+}
+
+std::shared_ptr<RobotLibrary> RobotLibrary::open(const std::string& path, std::string& error, bool validate)
+{
+    void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle)
+    {
+        error = dlerror();
+        return nullptr;
+    }
+
+    RobotFactory create_robot = (RobotFactory)dlsym(handle, "create_robot");
+    if (!create_robot)
+    {
+        error = "no create_robot: " + std::string(dlerror());
+        dlclose(handle);
+        return nullptr;
+    }
+
+    if (validate)
+    {
+        error = checkAbi(handle, create_robot);
+        if (!error.empty())
+        {
+            dlclose(handle);
+            return nullptr;
+        }
+    }
+
+    std::shared_ptr<RobotLibrary> library(new RobotLibrary(path, handle, create_robot));
+    library->saveHook = (RobotSaveState)dlsym(handle, "save_robot_state");
+    library->loadHook = (RobotLoadState)dlsym(handle, "load_robot_state");
+    library->configHook = (RobotConfigFactory)dlsym(handle, "create_robot_with_config");
+    return library;
+}
+
+// Each library carries its own compiled copy of RobotBase. If that copy doesn't match ours the arena
+// reads health/armor/etc. from the wrong offsets, so build a probe robot and check that everything we
+// read through our layout holds the invariants RobotBase's constructor guarantees.
+std::string RobotLibrary::checkAbi(void* handle, RobotFactory factory)
+{
+    if (!dlsym(handle, "_ZN9RobotBaseC2Eii10WeaponType") || !dlsym(handle, "_ZTS9RobotBase"))
+    {
+        return "not linked against this RobotBase";
+    }
+
+    RobotBase* probe = factory();
+    if (!probe)
+    {
+        return "create_robot returned null";
+    }
+
+    std::string problem;
+    int move = probe->get_move_speed();
+    int armor = probe->get_armor();
+    int weapon = probe->get_weapon();
+
+    if (probe->get_health() != 100)
+        problem = "health is not 100";
+    else if (move < 2 || move > 5)
+        problem = "move speed out of range";
+    else if (armor < 0 || armor > 7 - move)
+        problem = "armor out of range";
+    else if (weapon < flamethrower || weapon > hammer)
+        problem = "unknown weapon";
+    else if (probe->get_grenades() != (weapon == grenade ? 15 : 0))
+        problem = "grenade count does not match weapon";
+    else if (probe->m_name.size() > 256)
+        problem = "name field is garbage";
+
+    delete probe;
+    return problem.empty() ? problem : "RobotBase layout mismatch: " + problem;
+}
+
+int RobotRegistry::add(const std::string& path)
+{
+    Entry entry;
+    entry.path = path;
+    entries.push_back(std::move(entry));
+    return static_cast<int>(entries.size()) - 1;
+}
+
+int RobotRegistry::validateAll()
+{
+    int valid = 0;
+    for (Entry& entry : entries)
+    {
+        // Drop the mapping again straight away - most libraries won't be needed for a while
+        std::string error;
+        bool opened = RobotLibrary::open(entry.path, error) != nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            entry.valid = opened;
+            entry.error = error;
+        }
+        if (opened)
+        {
+            ++valid;
+        }
+        else
+        {
+            std::cerr << "Rejected " << entry.path << ": " << error << '\n';
+        }
+    }
+    return valid;
+}
+
+std::shared_ptr<RobotLibrary> RobotRegistry::acquire(int id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry& entry = entries[id];
+    if (entry.pending)
+    {
+        entry.library = std::move(entry.pending);
+        entry.valid = true;
+    }
+    if (!entry.valid)
+    {
+        return nullptr;
+    }
+    if (!entry.library)
+    {
+        entry.library = RobotLibrary::open(entry.path, entry.error, false);
+        if (!entry.library)
+        {
+            std::cerr << "Failed to map " << entry.path << ": " << entry.error << '\n';
+            entry.valid = false;
+        }
+    }
+    return entry.library;
+}
+
+bool RobotRegistry::isValid(int id) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries[id].valid;
+}
+
+std::string RobotRegistry::path(int id) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries[id].path;
+}
+
+std::string RobotRegistry::error(int id) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries[id].error;
+}
+
+bool RobotRegistry::reload(int id, const std::string& builtLib)
+{
+    int generation;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        generation = ++entries[id].generation;
+    }
+
+    // dlopen hands back the already loaded library for a path it has seen, so load the new
+    // build from a private copy. The copy can be deleted as soon as it is mapped.
+    namespace fs = std::filesystem;
+    fs::path copy = fs::temp_directory_path() / ("robotwarz-" + std::to_string(getpid()) + "-" +
+                    std::to_string(id) + "-" + std::to_string(generation) + ".so");
+    std::error_code ec;
+    fs::copy_file(builtLib, copy, fs::copy_options::overwrite_existing, ec);
+    if (ec)
+    {
+        std::cerr << "Reload of " << builtLib << " failed: " << ec.message() << '\n';
+        return false;
+    }
+
+    std::string error;
+    std::shared_ptr<RobotLibrary> library = RobotLibrary::open(copy.string(), error);
+    fs::remove(copy, ec);
+    if (!library)
+    {
+        std::cerr << "Reload of " << builtLib << " rejected: " << error << '\n';
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    entries[id].pending = std::move(library);
+    return true;
+}
+
+int RobotRegistry::find(const std::string& fileName) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t id = 0; id < entries.size(); ++id)
+    {
+        if (std::filesystem::path(entries[id].path).filename() == fileName)
+        {
+            return static_cast<int>(id);
+        }
+    }
+    return -1;
+}
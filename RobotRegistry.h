@@ -0,0 +1,93 @@
+#ifndef ROBOT_REGISTRY_H
+#define ROBOT_REGISTRY_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "RobotBase.h"
+#include "RobotConfig.h"
+
+// Optional hooks a robot library can export (extern "C") so its robots' own state survives an
+// arena checkpoint. Robots without them resume with whatever state create_robot gives them.
+typedef void (*RobotSaveState)(RobotBase* robot, std::string& state);   // save_robot_state
+typedef bool (*RobotLoadState)(RobotBase* robot, const std::string& state); // load_robot_state
+
+// A loaded robot shared library. The library stays mapped for as long as anyone holds
+// a shared_ptr to it, so arenas keep their robots' code alive until they are done.
+class RobotLibrary
+{
+public:
+    // dlopen with RTLD_NOW so missing symbols fail here instead of in the middle of a game.
+    // With validate set, a probe robot is created and checked against our RobotBase layout.
+    static std::shared_ptr<RobotLibrary> open(const std::string& path, std::string& error, bool validate = true);
+
+    RobotLibrary(const RobotLibrary&) = delete;
+    RobotLibrary& operator=(const RobotLibrary&) = delete;
+    ~RobotLibrary();
+
+    RobotBase* create() const { return factory(); }
+    // Null if the library doesn't export create_robot_with_config
+    RobotBase* create(const RobotConfig& config) const { return configHook ? configHook(&config) : nullptr; }
+    bool configurable() const { return configHook != nullptr; }
+    const std::string& path() const { return libPath; }
+
+    // Null when the library doesn't export them
+    RobotSaveState saveState() const { return saveHook; }
+    RobotLoadState loadState() const { return loadHook; }
+
+private:
+    RobotLibrary(const std::string& path, void* handle, RobotFactory factory);
+    static std::string checkAbi(void* handle, RobotFactory factory);
+
+    std::string libPath;
+    void* handle;
+    RobotFactory factory; // cached create_robot
+    RobotSaveState saveHook = nullptr;
+    RobotLoadState loadHook = nullptr;
+    RobotConfigFactory configHook = nullptr;
+};
+
+// Every robot library in a tournament. Libraries are validated once up front, but only
+// mapped again when a game actually asks for them.
+class RobotRegistry
+{
+public:
+    int add(const std::string& path);
+
+    // Validate every library, returns how many passed. Failures are reported on stderr.
+    int validateAll();
+
+    // Map a validated library (or reuse the mapping). Returns nullptr for invalid ids.
+    // A pending reload is swapped in here, so it takes effect at the next game boundary.
+    std::shared_ptr<RobotLibrary> acquire(int id);
+
+    // Validate a fresh build of a library and stage it for the next acquire. Games still
+    // running keep the old build, which is unmapped when the last of them finishes.
+    bool reload(int id, const std::string& builtLib);
+
+    // Id of the library with this file name, or -1
+    int find(const std::string& fileName) const;
+
+    // acquire changes these from other threads, so they're read under the lock and copied out
+    size_t size() const { return entries.size(); }
+    bool isValid(int id) const;
+    std::string path(int id) const;
+    std::string error(int id) const;
+
+private:
+    struct Entry
+    {
+        std::string path;
+        bool valid = false;
+        std::string error;
+        std::shared_ptr<RobotLibrary> library;
+        std::shared_ptr<RobotLibrary> pending; // staged reload
+        int generation = 0;
+    };
+
+    std::vector<Entry> entries;
+    mutable std::mutex mutex;
+};
+
+#endif // ROBOT_REGISTRY_H
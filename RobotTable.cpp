@@ -0,0 +1,144 @@
+#include "RobotTable.h"
+#include <algorithm>
+
+RobotTable::~RobotTable()
+{
+    for (uint32_t slot : living)
+    {
+        MemoryScope charge(accounts[slot]);
+        delete robotOf[slot];
+    }
+    for (MemoryAccount* account : accounts)
+    {
+        closeMemoryAccount(account);
+    }
+}
+
+RobotHandle RobotTable::add(RobotBase* robot, std::shared_ptr<RobotLibrary> library, char symbol, MemoryAccount* account)
+{
+    uint32_t slot = static_cast<uint32_t>(robotOf.size());
+    robotOf.push_back(robot);
+    generations.push_back(0);
+    symbols.push_back(symbol);
+    libraries.push_back(std::move(library));
+    accounts.push_back(account);
+    finished.push_back(-1);
+    rows.push_back(0);
+    cols.push_back(0);
+    healths.push_back(0);
+    armors.push_back(0);
+    moves.push_back(0);
+    grenadeCounts.push_back(0);
+    weapons.push_back(flamethrower);
+    aliveFlags.push_back(0);
+    mirror(slot, robot);
+    livingIndex.push_back(static_cast<uint32_t>(living.size()));
+    living.push_back(slot);
+    return handle(slot);
+}
+
+void RobotTable::remove(RobotHandle handle, int round)
+{
+    RobotBase* robot = get(handle);
+    if (!robot)
+    {
+        return;
+    }
+
+    uint32_t slot = handle.slot();
+    {
+        MemoryScope charge(accounts[slot]);
+        delete robot;
+    }
+    robotOf[slot] = nullptr;
+    aliveFlags[slot] = 0;
+    ++generations[slot];
+    finished[slot] = round;
+
+    // Swap the last living robot into the hole
+    uint32_t index = livingIndex[slot];
+    living[index] = living.back();
+    livingIndex[living[index]] = index;
+    living.pop_back();
+}
+
+void RobotTable::restore(const std::vector<int>& finishRounds, const std::vector<char>& slotSymbols)
+{
+    finished = finishRounds;
+    symbols = slotSymbols;
+    robotOf.assign(finished.size(), nullptr);
+    libraries.assign(finished.size(), nullptr);
+    accounts.assign(finished.size(), nullptr);
+    livingIndex.assign(finished.size(), 0);
+    living.clear();
+    rows.assign(finished.size(), 0);
+    cols.assign(finished.size(), 0);
+    healths.assign(finished.size(), 0);
+    armors.assign(finished.size(), 0);
+    moves.assign(finished.size(), 0);
+    grenadeCounts.assign(finished.size(), 0);
+    weapons.assign(finished.size(), flamethrower);
+    aliveFlags.assign(finished.size(), 0);
+
+    // Slots are never reused, so a slot has been through one generation if its robot died
+    generations.resize(finished.size());
+    for (size_t slot = 0; slot < finished.size(); ++slot)
+    {
+        generations[slot] = finished[slot] >= 0 ? 1 : 0;
+    }
+}
+
+RobotHandle RobotTable::put(uint32_t slot, RobotBase* robot, std::shared_ptr<RobotLibrary> library, MemoryAccount* account)
+{
+    robotOf[slot] = robot;
+    libraries[slot] = std::move(library);
+    accounts[slot] = account;
+    mirror(slot, robot);
+    livingIndex[slot] = static_cast<uint32_t>(living.size());
+    living.push_back(slot);
+    return handle(slot);
+}
+
+void RobotTable::mirror(uint32_t slot, RobotBase* robot)
+{
+    robot->get_current_location(rows[slot], cols[slot]);
+    healths[slot] = robot->get_health();
+    armors[slot] = robot->get_armor();
+    moves[slot] = robot->get_move_speed();
+    grenadeCounts[slot] = robot->get_grenades();
+    weapons[slot] = robot->get_weapon();
+    aliveFlags[slot] = 1;
+}
+
+void RobotTable::moveTo(uint32_t slot, int row, int col)
+{
+    rows[slot] = row;
+    cols[slot] = col;
+    robotOf[slot]->move_to(row, col);
+}
+
+// Same rules as RobotBase: health and armor stop at zero
+int RobotTable::takeDamage(uint32_t slot, int damage)
+{
+    healths[slot] = std::max(0, healths[slot] - damage);
+    robotOf[slot]->take_damage(damage);
+    return healths[slot];
+}
+
+void RobotTable::reduceArmor(uint32_t slot, int amount)
+{
+    armors[slot] = std::max(0, armors[slot] - amount);
+    robotOf[slot]->reduce_armor(amount);
+}
+
+void RobotTable::disableMovement(uint32_t slot)
+{
+    moves[slot] = 0;
+    robotOf[slot]->disable_movement();
+}
+
+void RobotTable::useGrenade(uint32_t slot)
+{
+    grenadeCounts[slot] = std::max(0, grenadeCounts[slot] - 1);
+    robotOf[slot]->decrement_grenades();
+}
@@ -0,0 +1,107 @@
+#ifndef ROBOT_TABLE_H
+#define ROBOT_TABLE_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Cell.h"
+#include "RobotBase.h"
+#include "RobotMemory.h"
+#include "RobotRegistry.h"
+
+// Every robot in a game, by slot.
+//
+// A robot's slot is its load order and never changes or gets reused, so it names the robot for
+// the whole game: in cells (through a RobotHandle), in checkpoints and in GameResult. What the
+// arena keeps about each robot sits in one array per field indexed by slot.
+//
+// That includes the state the arena changes: position, health, armor, move speed and grenades. The table
+// is the authority on those. Every change goes through it and is passed on to the robot with
+// RobotBase's own mutators, so the robot sees the same values, but the arena never reads them
+// back: its loops run over these arrays instead of calling into each robot's library.
+//
+// The living robots are a separate list of slots in turn order. Removing one moves the last
+// living robot into its place, so a death costs the same however many robots there are; it
+// does mean the turn order changes after a death.
+//
+// Each slot also has the robot's heap account (RobotMemory.h). The table runs the robot's
+// destructor under it, and keeps the account after the robot is gone so its peak and whatever
+// it leaked can still be reported.
+class RobotTable
+{
+public:
+    RobotTable() = default;
+    RobotTable(const RobotTable&) = delete;
+    RobotTable& operator=(const RobotTable&) = delete;
+
+    // Living robots are deleted here, while their libraries are still loaded
+    ~RobotTable();
+
+    // Take ownership of a robot, and its heap account, in the next slot. library is null for robots
+    // built into the program.
+    RobotHandle add(RobotBase* robot, std::shared_ptr<RobotLibrary> library, char symbol, MemoryAccount* account);
+
+    // Delete a dead robot and take it out of the living list. Its handles stop finding it.
+    void remove(RobotHandle handle, int round);
+
+    // Changes to a robot, mirrored onto the robot object
+    void moveTo(uint32_t slot, int row, int col);
+    int takeDamage(uint32_t slot, int damage); // returns the health left
+    void reduceArmor(uint32_t slot, int amount);
+    void disableMovement(uint32_t slot);
+    void useGrenade(uint32_t slot);
+
+    int row(uint32_t slot) const { return rows[slot]; }
+    int col(uint32_t slot) const { return cols[slot]; }
+    int health(uint32_t slot) const { return healths[slot]; }
+    int armor(uint32_t slot) const { return armors[slot]; }
+    int moveSpeed(uint32_t slot) const { return moves[slot]; }
+    int grenades(uint32_t slot) const { return grenadeCounts[slot]; }
+    WeaponType weapon(uint32_t slot) const { return weapons[slot]; }
+    bool alive(uint32_t slot) const { return aliveFlags[slot]; }
+
+    // Null for a handle whose robot has been removed
+    RobotBase* get(RobotHandle handle) const
+    {
+        return handle && handle.slot() < robotOf.size() && generations[handle.slot()] == handle.generation()
+            ? robotOf[handle.slot()] : nullptr;
+    }
+
+    size_t livingCount() const { return living.size(); }
+    RobotHandle livingAt(size_t i) const { return handle(living[i]); }
+    RobotBase* livingRobot(size_t i) const { return robotOf[living[i]]; }
+
+    size_t slots() const { return robotOf.size(); }
+    RobotHandle handle(uint32_t slot) const { return RobotHandle(slot, generations[slot]); }
+    char symbol(uint32_t slot) const { return symbols[slot]; }
+    const std::shared_ptr<RobotLibrary>& library(uint32_t slot) const { return libraries[slot]; }
+    const std::vector<int>& finishRounds() const { return finished; } // as in GameResult
+    MemoryAccount* account(uint32_t slot) const { return accounts[slot]; } // null for a slot restored dead
+
+    // For resuming a checkpoint: set up slots as they were, then put the living robots back in
+    // turn order. The table must be empty.
+    void restore(const std::vector<int>& finishRounds, const std::vector<char>& slotSymbols);
+    RobotHandle put(uint32_t slot, RobotBase* robot, std::shared_ptr<RobotLibrary> library, MemoryAccount* account);
+
+private:
+    void mirror(uint32_t slot, RobotBase* robot); // take the robot's values as they are now
+
+    std::vector<RobotBase*> robotOf;   // null once removed
+    std::vector<uint8_t> generations;  // bumped when the robot is removed
+    std::vector<char> symbols;         // what the board shows after the R or X
+    std::vector<std::shared_ptr<RobotLibrary>> libraries;
+    std::vector<MemoryAccount*> accounts;
+    std::vector<int> finished;         // round the robot died in, -1 while alive
+    std::vector<int32_t> rows;
+    std::vector<int32_t> cols;
+    std::vector<int32_t> healths;
+    std::vector<int32_t> armors;
+    std::vector<int32_t> moves;
+    std::vector<int32_t> grenadeCounts;
+    std::vector<WeaponType> weapons;
+    std::vector<uint8_t> aliveFlags;
+    std::vector<uint32_t> living;      // slots of the living robots, in turn order
+    std::vector<uint32_t> livingIndex; // per slot, its position in living
+};
+
+#endif // ROBOT_TABLE_H
@@ -0,0 +1,266 @@
+#include "RobotTuner.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <ctime>
+#include <thread>
+#include "Weapons.h"
+
+namespace
+{
+
+// RobotBase's limits: move 2-5, armor from what's left of 7
+void clampConfig(RobotConfig& config)
+{
+    config.move = std::clamp(config.move, 2, 5);
+    config.armor = std::clamp(config.armor, 0, 7 - config.move);
+}
+
+bool sameBuild(const RobotConfig& a, const RobotConfig& b)
+{
+    return a.move == b.move && a.armor == b.armor && a.weapon == b.weapon;
+}
+
+} // namespace
+
+std::string describeConfig(const RobotConfig& config)
+{
+    return "move " + std::to_string(config.move) + " armor " + std::to_string(config.armor) + " " +
+           weaponSpecs[config.weapon].name;
+}
+
+RobotTuner::RobotTuner(const std::string& library, const std::vector<std::string>& opponents, const TunerConfig& config)
+: config(config), rng(config.seed ? config.seed : static_cast<unsigned>(std::time(nullptr)))
+{
+    this->config.population = std::max(2, config.population);
+    this->config.elites = std::clamp(config.elites, 0, this->config.population - 1);
+    this->config.gamesPerCandidate = std::max(1, config.gamesPerCandidate);
+    this->config.groupSize = std::max(2, config.groupSize);
+    this->config.workers = std::max(1, config.workers);
+    this->config.arena.verbose = false;
+
+    robotId = registry.add(library);
+    for (const std::string& lib : opponents.empty() ? std::vector<std::string>{ library } : opponents)
+    {
+        opponentIds.push_back(registry.add(lib));
+    }
+    registry.validateAll();
+}
+
+bool RobotTuner::ready(std::string& error)
+{
+    if (!registry.isValid(robotId))
+    {
+        error = registry.path(robotId) + ": " + registry.error(robotId);
+        return false;
+    }
+    std::shared_ptr<RobotLibrary> library = registry.acquire(robotId);
+    if (!library || !library->configurable())
+    {
+        error = registry.path(robotId) + " doesn't export create_robot_with_config";
+        return false;
+    }
+    opponentIds.erase(std::remove_if(opponentIds.begin(), opponentIds.end(),
+                                     [&](int id) { return !registry.isValid(id); }),
+                      opponentIds.end());
+    if (opponentIds.empty())
+    {
+        error = "no opponent loaded";
+        return false;
+    }
+    return true;
+}
+
+RobotConfig RobotTuner::randomConfig()
+{
+    RobotConfig robot;
+    robot.move = std::uniform_int_distribution<int>(2, 5)(rng);
+    robot.armor = std::uniform_int_distribution<int>(0, 7 - robot.move)(rng);
+    robot.weapon = static_cast<WeaponType>(std::uniform_int_distribution<int>(0, weaponCount - 1)(rng));
+    return robot;
+}
+
+// The build the library's create_robot picks, the one to beat
+RobotConfig RobotTuner::defaultConfig()
+{
+    RobotConfig robot;
+    RobotBase* probe = registry.acquire(robotId)->create();
+    if (probe)
+    {
+        robot.move = probe->get_move_speed();
+        robot.armor = probe->get_armor();
+        robot.weapon = probe->get_weapon();
+        delete probe;
+    }
+    return robot;
+}
+
+// Uniform crossover, then each gene mutates on its own
+RobotConfig RobotTuner::breed(const RobotConfig& a, const RobotConfig& b)
+{
+    std::bernoulli_distribution coin(0.5), mutate(config.mutationRate);
+    std::uniform_int_distribution<int> step(0, 1);
+
+    RobotConfig child;
+    child.move = coin(rng) ? a.move : b.move;
+    child.armor = coin(rng) ? a.armor : b.armor;
+    child.weapon = coin(rng) ? a.weapon : b.weapon;
+
+    if (mutate(rng))
+    {
+        child.move += step(rng) ? 1 : -1;
+    }
+    if (mutate(rng))
+    {
+        child.armor += step(rng) ? 1 : -1;
+    }
+    if (mutate(rng))
+    {
+        child.weapon = static_cast<WeaponType>(std::uniform_int_distribution<int>(0, weaponCount - 1)(rng));
+    }
+    clampConfig(child);
+    return child;
+}
+
+// Binary tournament: the fitter of two picked at random
+const TunedRobot& RobotTuner::select(const std::vector<TunedRobot>& ranked)
+{
+    std::uniform_int_distribution<size_t> pick(0, ranked.size() - 1);
+    const TunedRobot& a = ranked[pick(rng)];
+    const TunedRobot& b = ranked[pick(rng)];
+    return a.fitness >= b.fitness ? a : b;
+}
+
+// One headless game, scored as the share of opponents the candidate outlasted (ties count half)
+double RobotTuner::playGame(const RobotConfig& candidate, unsigned seed, int game)
+{
+    ArenaConfig arenaConfig = config.arena;
+    arenaConfig.seed = seed;
+    Arena arena(arenaConfig);
+    arena.placeObstacles();
+
+    std::shared_ptr<RobotLibrary> library = registry.acquire(robotId);
+    if (!library || !arena.addRobot(library, candidate))
+    {
+        return 0;
+    }
+    // Opponents take turns round the list, the same ones for game N of every candidate
+    int opponents = config.groupSize - 1;
+    std::vector<int> ids;
+    for (int k = 0; k < opponents; ++k)
+    {
+        ids.push_back(opponentIds[(static_cast<size_t>(game) * opponents + k) % opponentIds.size()]);
+    }
+    arena.loadRobots(registry, ids);
+
+    GameResult result = arena.startBattle();
+    if (result.finishRound.size() < 2)
+    {
+        return 0;
+    }
+    int lasted = result.finishRound[0] < 0 ? INT_MAX : result.finishRound[0];
+    double score = 0;
+    for (size_t slot = 1; slot < result.finishRound.size(); ++slot)
+    {
+        int other = result.finishRound[slot] < 0 ? INT_MAX : result.finishRound[slot];
+        score += lasted > other ? 1.0 : (lasted == other ? 0.5 : 0.0);
+    }
+    return score / static_cast<double>(result.finishRound.size() - 1);
+}
+
+// Every candidate against every seed, the games shared out over the worker threads
+std::vector<double> RobotTuner::evaluate(const std::vector<RobotConfig>& candidates, const std::vector<unsigned>& seeds)
+{
+    size_t games = candidates.size() * seeds.size();
+    std::vector<double> scores(games, 0.0);
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t g = next.fetch_add(1); g < games; g = next.fetch_add(1))
+        {
+            size_t game = g % seeds.size();
+            scores[g] = playGame(candidates[g / seeds.size()], seeds[game], static_cast<int>(game));
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < std::min<int>(config.workers, static_cast<int>(games)); ++t)
+    {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : pool)
+    {
+        thread.join();
+    }
+
+    std::vector<double> fitness(candidates.size(), 0.0);
+    for (size_t g = 0; g < games; ++g)
+    {
+        fitness[g / seeds.size()] += scores[g] / static_cast<double>(seeds.size());
+    }
+    return fitness;
+}
+
+TunedRobot RobotTuner::run(const std::function<void(const GenerationReport&)>& onGeneration)
+{
+    // The robot's own build starts in the pool, the rest is random
+    std::vector<RobotConfig> candidates{ defaultConfig() };
+    while (static_cast<int>(candidates.size()) < config.population)
+    {
+        candidates.push_back(randomConfig());
+    }
+
+    std::vector<TunedRobot> ranked;
+    long long gamesPlayed = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int generation = 0; generation < config.generations; ++generation)
+    {
+        std::vector<unsigned> seeds(static_cast<size_t>(config.gamesPerCandidate));
+        for (unsigned& seed : seeds)
+        {
+            seed = rng() | 1; // 0 would mean "seed from the clock"
+        }
+        std::vector<double> fitness = evaluate(candidates, seeds);
+        gamesPlayed += static_cast<long long>(candidates.size() * seeds.size());
+
+        ranked.clear();
+        for (size_t i = 0; i < candidates.size(); ++i)
+        {
+            ranked.push_back(TunedRobot{candidates[i], fitness[i]});
+        }
+        std::stable_sort(ranked.begin(), ranked.end(), [](const TunedRobot& a, const TunedRobot& b) {
+            return a.fitness > b.fitness;
+        });
+
+        if (onGeneration)
+        {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            GenerationReport report;
+            report.generation = generation;
+            report.best = ranked.front();
+            for (const TunedRobot& robot : ranked)
+            {
+                report.meanFitness += robot.fitness / static_cast<double>(ranked.size());
+                report.converged += sameBuild(robot.config, ranked.front().config) ? 1.0 / static_cast<double>(ranked.size()) : 0.0;
+            }
+            report.generationsPerSecond = (generation + 1) / elapsed.count();
+            report.gamesPerSecond = static_cast<double>(gamesPlayed) / elapsed.count();
+            onGeneration(report);
+        }
+
+        // Elites through unchanged, children for the rest
+        candidates.clear();
+        for (int i = 0; i < config.elites; ++i)
+        {
+            candidates.push_back(ranked[static_cast<size_t>(i)].config);
+        }
+        while (static_cast<int>(candidates.size()) < config.population)
+        {
+            const TunedRobot& a = select(ranked);
+            const TunedRobot& b = select(ranked);
+            candidates.push_back(breed(a.config, b.config));
+        }
+    }
+    return ranked.empty() ? TunedRobot{} : ranked.front();
+}
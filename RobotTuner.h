@@ -0,0 +1,81 @@
+#ifndef ROBOT_TUNER_H
+#define ROBOT_TUNER_H
+
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include "Arena.h"
+#include "RobotConfig.h"
+#include "RobotRegistry.h"
+
+struct TunerConfig
+{
+    int population = 16;
+    int generations = 10;
+    int gamesPerCandidate = 8; // every candidate in a generation gets the same seeds and opponents
+    int groupSize = 4;         // robots per game: the candidate and groupSize - 1 opponents
+    int elites = 4;            // best candidates carried into the next generation unchanged
+    double mutationRate = 0.3; // chance of each of move, armor and weapon changing in a child
+    int workers = 1;           // threads playing games
+    unsigned seed = 0;         // 0 picks a seed from the clock
+    ArenaConfig arena;         // template for every game, seed is filled in per game
+};
+
+struct TunedRobot
+{
+    RobotConfig config;
+    double fitness = 0; // share of opponents outlasted over its games, 0 to 1
+};
+
+struct GenerationReport
+{
+    int generation = 0;
+    TunedRobot best;
+    double meanFitness = 0;
+    double converged = 0;      // share of the population built the same as the best
+    double generationsPerSecond = 0;
+    double gamesPerSecond = 0; // both so far in the run
+};
+
+// Evolves the move/armor/weapon build of one robot library. RobotBase gives every robot 7 points
+// to split between move (2-5) and armor, and one of four weapons; which build suits a robot's
+// tactics is found here by playing it. The library has to export create_robot_with_config
+// (RobotConfig.h).
+//
+// Each generation every candidate plays gamesPerCandidate headless games against the opponent
+// libraries, spread over worker threads, and scores the share of opponents it outlasted. The
+// seeds are fresh each generation but shared by all its candidates, so they're compared on the
+// same boards, and elites have to earn their place again rather than living off one lucky run.
+// The next generation is the elites plus children of tournament-selected parents, crossed
+// over gene by gene and mutated.
+class RobotTuner
+{
+public:
+    // With no opponents the robot plays against its own default build
+    RobotTuner(const std::string& library, const std::vector<std::string>& opponents, const TunerConfig& config);
+
+    // False, with the reason, if the robot or every opponent failed to load
+    bool ready(std::string& error);
+
+    // Run every generation, calling onGeneration after each. Returns the best robot of the last one.
+    TunedRobot run(const std::function<void(const GenerationReport&)>& onGeneration);
+
+private:
+    TunerConfig config;
+    RobotRegistry registry;
+    int robotId;
+    std::vector<int> opponentIds;
+    std::mt19937 rng;
+
+    RobotConfig randomConfig();
+    RobotConfig defaultConfig();
+    RobotConfig breed(const RobotConfig& a, const RobotConfig& b);
+    const TunedRobot& select(const std::vector<TunedRobot>& ranked);
+    std::vector<double> evaluate(const std::vector<RobotConfig>& candidates, const std::vector<unsigned>& seeds);
+    double playGame(const RobotConfig& candidate, unsigned seed, int game);
+};
+
+std::string describeConfig(const RobotConfig& config);
+
+#endif // ROBOT_TUNER_H
@@ -1,11 +1,343 @@
 #include "Arena.h"
+#include "MatchScheduler.h"
+#include "RobotWatcher.h"
+#include "WorkerPool.h"
+#include "RobotTuner.h"
 #include <vector>
 #include <string>
+#include <thread>
+#include <ctime>
 
-int main()
+// A heatmap the size of the board the config describes, for --heatmap
+std::shared_ptr<ArenaTelemetry> makeHeatmap(const ArenaConfig& config)
 {
-    Arena arena(10,10);
-    arena.placeObstacles();
+    return config.map ? std::make_shared<ArenaTelemetry>(config.map->rows(), config.map->cols())
+                      : std::make_shared<ArenaTelemetry>(config.rows, config.cols);
+}
+
+bool saveHeatmap(const ArenaTelemetry& telemetry, const std::string& path)
+{
+    std::string error;
+    if (!telemetry.save(path, error))
+    {
+        std::cerr << "Cannot save heatmap: " << error << "\n";
+        return false;
+    }
+    return true;
+}
+
+// Each robot's heap over the game, for a single game. names are by slot; slots without one go by number.
+void printMemory(const GameResult& result, const std::vector<std::string>& names)
+{
+    std::cout << "\n=========== Robot Heap (bytes) ===========\n";
+    for (size_t slot = 0; slot < result.memory.size(); ++slot)
+    {
+        const RobotMemoryUse& use = result.memory[slot];
+        std::cout << (slot < names.size() ? names[slot] : "slot " + std::to_string(slot))
+                  << "\tpeak " << use.peak << "\tlive " << use.live
+                  << (use.overCap ? "\tover cap" : "") << "\n";
+    }
+}
+
+// Map a map file for ArenaConfig::map, reporting why on failure
+bool loadMap(const std::string& path, ArenaConfig& config)
+{
+    std::string error;
+    config.map = ObstacleLayout::map(path, error);
+    if (!config.map)
+    {
+        std::cerr << "Cannot load map: " << error << "\n";
+        return false;
+    }
+    return true;
+}
+
+// --style NAME and --symmetric, shared by every mode. Returns false if arg isn't one of them.
+bool parseMapOption(const std::string& arg, int& i, int argc, char* argv[], ArenaConfig& config)
+{
+    if (arg == "--symmetric")
+    {
+        config.symmetricMap = true;
+        return true;
+    }
+    if (arg == "--style" && i + 1 < argc)
+    {
+        std::string style = argv[++i];
+        if (!parseMapStyle(style, config.mapStyle))
+        {
+            std::cerr << "Unknown map style " << style << ", using scatter\n";
+        }
+        return true;
+    }
+    return false;
+}
+
+// RobotWarz --make-map FILE ROWS COLS [--seed N] [--style scatter|caves|maze|clusters] [--symmetric]
+int makeMap(int argc, char* argv[])
+{
+    if (argc < 5)
+    {
+        std::cerr << "usage: RobotWarz --make-map FILE ROWS COLS [--seed N] [--style NAME] [--symmetric]\n";
+        return 1;
+    }
+
+    ArenaConfig config;
+    for (int i = 5; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc) config.seed = std::stoul(argv[++i]);
+        else parseMapOption(arg, i, argc, argv, config);
+    }
+
+    std::mt19937 rng(config.seed ? config.seed : static_cast<unsigned>(std::time(nullptr)));
+    ObstacleLayout layout = MapGenerator::generate(std::stoi(argv[3]), std::stoi(argv[4]),
+                                                   config.mapStyle, config.symmetricMap, rng);
+
+    std::string error;
+    if (!layout.save(argv[2], error))
+    {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    std::cout << "Wrote " << argv[2] << ": " << layout.rows() << "x" << layout.cols() << ", "
+              << layout.obstacleCount() << " obstacles\n";
+    return 0;
+}
+
+// RobotWarz --tournament [--mode swiss|roundrobin|random] [--rounds N] [--group N] [--workers N]
+//                        [--processes N] [--size ROWS COLS] [--map FILE | --style NAME [--symmetric]] [--watch DIR]
+//                        [--game-timeout SECONDS] [--heatmap FILE] [--memory-cap KIB] lib...
+int runTournament(int argc, char* argv[])
+{
+    SchedulerConfig config;
+    config.workers = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::string> robotLibs;
+    std::string watchDir;
+    std::string heatmapPath;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--mode" && i + 1 < argc)
+        {
+            std::string mode = argv[++i];
+            config.mode = mode == "roundrobin" ? PairingMode::RoundRobin
+                        : mode == "random"     ? PairingMode::Random
+                                               : PairingMode::Swiss;
+        }
+        else if (arg == "--rounds" && i + 1 < argc)  config.rounds = std::stoi(argv[++i]);
+        else if (arg == "--group" && i + 1 < argc)   config.groupSize = std::stoi(argv[++i]);
+        else if (arg == "--workers" && i + 1 < argc) config.workers = std::stoi(argv[++i]);
+        else if (arg == "--processes" && i + 1 < argc) config.processes = std::stoi(argv[++i]); // instead of --workers, see WorkerPool.h
+        else if (arg == "--game-timeout" && i + 1 < argc) config.gameTimeout = std::stoi(argv[++i]); // for --processes
+        else if (arg == "--watch" && i + 1 < argc)   watchDir = argv[++i];
+        else if (arg == "--heatmap" && i + 1 < argc) heatmapPath = argv[++i]; // see ArenaTelemetry.h, .csv for CSV
+        else if (arg == "--memory-cap" && i + 1 < argc) config.arena.memoryCap = std::stoll(argv[++i]) * 1024; // see RobotMemory.h
+        else if (arg == "--log" && i + 1 < argc)
+        {
+            // every game's full log in one file, a block per round
+            config.arena.log = std::make_shared<LogSink>(std::string(argv[++i]));
+            if (!config.arena.log->good())
+            {
+                std::cerr << "Cannot write log " << argv[i] << "\n";
+                return 1;
+            }
+        }
+        else if (arg == "--map" && i + 1 < argc)
+        {
+            config.mapPath = argv[++i];
+            if (!loadMap(config.mapPath, config.arena)) return 1;
+        }
+        else if (parseMapOption(arg, i, argc, argv, config.arena)) continue;
+        else if (arg == "--size" && i + 2 < argc)
+        {
+            config.arena.rows = std::stoi(argv[++i]);
+            config.arena.cols = std::stoi(argv[++i]);
+        }
+        else if (arg.rfind("--", 0) == 0)
+        {
+            // Or it would be taken for a robot library
+            std::cerr << "Unknown tournament option " << arg << "\n";
+            return 1;
+        }
+        else robotLibs.push_back(arg);
+    }
+
+    if (robotLibs.size() < 2)
+    {
+        std::cerr << "A tournament needs at least two robot libraries\n";
+        return 1;
+    }
+
+    if (!heatmapPath.empty())
+    {
+        if (config.processes > 0)
+        {
+            std::cerr << "--heatmap counts games played in this process, it can't be used with --processes\n";
+            return 1;
+        }
+        config.arena.telemetry = makeHeatmap(config.arena);
+    }
+
+    MatchScheduler scheduler(robotLibs, config);
+
+    // Rebuild and swap in robots that change while the tournament runs
+    RobotWatcher watcher(scheduler.robots(), watchDir);
+    if (!watchDir.empty())
+    {
+        watcher.start();
+    }
+
+    scheduler.run([&](const MatchResult& result)
+    {
+        std::cout << "round " << result.match.round << " game " << result.match.id << ": ";
+        if (result.game.finishRound.empty())
+        {
+            std::cout << "no contest\n";
+            return;
+        }
+        for (int slot : result.game.placement)
+        {
+            std::cout << robotLibs[result.match.robots[slot]] << " ";
+        }
+        std::cout << (result.game.draw ? "(draw)" : "") << " in " << result.game.rounds << " rounds\n";
+    });
+
+    std::cout << "\n=========== Standings ===========\n";
+    for (const Standing& s : scheduler.standings())
+    {
+        std::cout << s.library << "\t" << static_cast<int>(s.rating) << "\t" << s.wins << "/" << s.games
+                  << "\tpeak heap " << s.peakHeap << "\n";
+    }
+
+    if (config.arena.telemetry && !saveHeatmap(*config.arena.telemetry, heatmapPath))
+    {
+        return 1;
+    }
+    if (profilingEnabled)
+    {
+        scheduler.profile().print(std::cout, "Tournament Profile");
+    }
+    return 0;
+}
+
+// Printed when the arguments don't make sense
+const char* tunerUsage =
+    "usage: RobotWarz --tune LIB [--population N] [--generations N] [--games N] [--group N] [--workers N]\n"
+    "                            [--seed N] [--size ROWS COLS] [--map FILE | --style NAME [--symmetric]] opponent...\n";
+
+int runTuner(int argc, char* argv[])
+{
+    if (argc < 3 || std::string(argv[2]).rfind("--", 0) == 0)
+    {
+        std::cerr << "--tune needs the robot library to tune\n" << tunerUsage;
+        return 1;
+    }
+    std::string library = argv[2];
+    TunerConfig config;
+    config.workers = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::string> opponents;
+
+    for (int i = 3; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--population" && i + 1 < argc)       config.population = std::stoi(argv[++i]);
+        else if (arg == "--generations" && i + 1 < argc) config.generations = std::stoi(argv[++i]);
+        else if (arg == "--games" && i + 1 < argc)       config.gamesPerCandidate = std::stoi(argv[++i]);
+        else if (arg == "--group" && i + 1 < argc)       config.groupSize = std::stoi(argv[++i]);
+        else if (arg == "--workers" && i + 1 < argc)     config.workers = std::stoi(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc)        config.seed = std::stoul(argv[++i]);
+        else if (arg == "--map" && i + 1 < argc)
+        {
+            if (!loadMap(argv[++i], config.arena)) return 1;
+        }
+        else if (parseMapOption(arg, i, argc, argv, config.arena)) continue;
+        else if (arg == "--size" && i + 2 < argc)
+        {
+            config.arena.rows = std::stoi(argv[++i]);
+            config.arena.cols = std::stoi(argv[++i]);
+        }
+        else if (arg.rfind("--", 0) == 0)
+        {
+            // Or it would be taken for an opponent library, and the run go ahead without it
+            std::cerr << "Unknown tuner option " << arg << "\n" << tunerUsage;
+            return 1;
+        }
+        else opponents.push_back(arg);
+    }
+
+    RobotTuner tuner(library, opponents, config);
+    std::string error;
+    if (!tuner.ready(error))
+    {
+        std::cerr << "Cannot tune: " << error << "\n";
+        return 1;
+    }
+
+    TunedRobot best = tuner.run([](const GenerationReport& report)
+    {
+        std::cout << "generation " << report.generation << ": best " << describeConfig(report.best.config)
+                  << " " << report.best.fitness << ", mean " << report.meanFitness << ", "
+                  << static_cast<int>(report.converged * 100 + 0.5) << "% converged, "
+                  << report.generationsPerSecond << " generations/s (" << static_cast<long long>(report.gamesPerSecond)
+                  << " games/s)\n";
+    });
+    std::cout << "\nBest build: " << describeConfig(best.config) << ", outlasted " << best.fitness * 100 << "% of opponents\n";
+    return 0;
+}
+
+// RobotWarz [--seed N] [--map FILE | --style NAME [--symmetric]] [--checkpoint FILE [--every N]] [--resume FILE]
+//           [--heatmap FILE] [--memory-cap KIB] [--memory]
+int main(int argc, char* argv[])
+{
+    if (argc > 1 && std::string(argv[1]) == "--tournament")
+    {
+        return runTournament(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--make-map")
+    {
+        return makeMap(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--tune")
+    {
+        return runTuner(argc, argv);
+    }
+    // A tournament's worker process, started by WorkerPool
+    if (argc > 2 && std::string(argv[1]) == "--worker")
+    {
+        return WorkerPool::serve(std::stoi(argv[2]));
+    }
+
+    ArenaConfig config;
+    std::string resumeFrom;
+    std::string heatmapPath;
+    bool showMemory = false; // the heap table, which --memory-cap shows as well
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc)            config.seed = std::stoul(argv[++i]);
+        else if (arg == "--checkpoint" && i + 1 < argc) config.checkpointPath = argv[++i];
+        else if (arg == "--every" && i + 1 < argc)      config.checkpointEvery = std::stoi(argv[++i]);
+        else if (arg == "--resume" && i + 1 < argc)     resumeFrom = argv[++i];
+        else if (arg == "--heatmap" && i + 1 < argc)    heatmapPath = argv[++i];
+        else if (arg == "--memory-cap" && i + 1 < argc) config.memoryCap = std::stoll(argv[++i]) * 1024;
+        else if (arg == "--memory")                     showMemory = true;
+        else if (arg == "--map" && i + 1 < argc)
+        {
+            if (!loadMap(argv[++i], config)) return 1;
+        }
+        else parseMapOption(arg, i, argc, argv, config);
+    }
+    if (!config.checkpointPath.empty() && config.checkpointEvery <= 0)
+    {
+        config.checkpointEvery = 100;
+    }
+
+    if (!heatmapPath.empty())
+    {
+        config.telemetry = makeHeatmap(config);
+    }
+    Arena arena(config);
 
     // list of shared library files for robots
     std::vector<std::string> robotLibs =
@@ -15,10 +347,38 @@ int main()
         "./libRobot_Ratboy.so"
     };
 
-    // load robots from shared libraries into arena
-    arena.loadRobots(robotLibs);
+    if (!resumeFrom.empty())
+    {
+        std::string error;
+        if (!arena.resume(resumeFrom, error))
+        {
+            std::cerr << "Cannot resume: " << error << "\n";
+            return 1;
+        }
+    }
+    else
+    {
+        arena.placeObstacles();
+
+        // load robots from shared libraries into arena
+        arena.loadRobots(robotLibs);
+    }
 
     // start battle
-    arena.startBattle();
+    GameResult result = arena.startBattle();
+    LogSink::standardOutput()->drain();
+    if (showMemory || config.memoryCap > 0)
+    {
+        // A resumed game's slots are whatever the checkpoint says, not this list
+        printMemory(result, resumeFrom.empty() ? robotLibs : std::vector<std::string>());
+    }
+    if (config.telemetry && !saveHeatmap(*config.telemetry, heatmapPath))
+    {
+        return 1;
+    }
+    if (profilingEnabled)
+    {
+        result.profile.print(std::cout, "Game Profile");
+    }
     return 0;
-}
\ No newline at end of file
+}
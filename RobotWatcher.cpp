@@ -0,0 +1,132 @@
+#include "RobotWatcher.h"
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+RobotWatcher::RobotWatcher(RobotRegistry& registry, const std::string& directory)
+: registry(registry), directory(directory)
+{
+}
+
+RobotWatcher::~RobotWatcher()
+{
+    stop();
+}
+
+bool RobotWatcher::start()
+{
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0)
+    {
+        std::cerr << "inotify unavailable, hot reload disabled\n";
+        return false;
+    }
+    // Compilers and editors finish a file with either a close or a rename
+    if (inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        std::cerr << "Cannot watch " << directory << ", hot reload disabled\n";
+        close(inotifyFd);
+        inotifyFd = -1;
+        return false;
+    }
+
+    running = true;
+    thread = std::thread(&RobotWatcher::watchLoop, this);
+    return true;
+}
+
+void RobotWatcher::stop()
+{
+    running = false;
+    if (thread.joinable())
+    {
+        thread.join();
+    }
+    if (inotifyFd >= 0)
+    {
+        close(inotifyFd);
+        inotifyFd = -1;
+    }
+}
+
+void RobotWatcher::watchLoop()
+{
+    alignas(inotify_event) char buffer[4096];
+    pollfd pfd{inotifyFd, POLLIN, 0};
+
+    while (running)
+    {
+        // Wake up now and then to notice stop()
+        if (poll(&pfd, 1, 200) <= 0)
+        {
+            continue;
+        }
+
+        ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+        for (ssize_t pos = 0; pos < length; )
+        {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + pos);
+            pos += sizeof(inotify_event) + event->len;
+            if (event->len == 0)
+            {
+                continue;
+            }
+
+            std::string name = event->name;
+            auto endsWith = [&](const std::string& suffix) {
+                return name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+            };
+
+            if (name.rfind("Robot_", 0) == 0 && endsWith(".cpp"))
+            {
+                rebuild(name);
+            }
+            else if (name.rfind("lib", 0) == 0 && endsWith(".so"))
+            {
+                reload(name);
+            }
+        }
+    }
+}
+
+// Build next to the old library and rename over it. The rename is atomic, games that still have the
+// old file mapped keep its inode, and the rename itself is what triggers the reload.
+void RobotWatcher::rebuild(const std::string& source)
+{
+    std::string stem = source.substr(0, source.find(".cpp"));
+    std::string sharedLib = directory + "/lib" + stem + ".so";
+    std::string building = sharedLib + ".building";
+
+    if (registry.find("lib" + stem + ".so") < 0)
+    {
+        return; // not part of this tournament
+    }
+
+    std::string compile_cmd = "g++ -shared -fPIC -o " + building + " " + directory + "/" + source + " " +
+                              directory + "/RobotBase.o -I" + directory + " -std=c++20";
+    std::cout << "Compiling " << source << " to " << sharedLib << "...\n";
+
+    if (std::system(compile_cmd.c_str()) != 0)
+    {
+        std::cerr << "Failed to compile " << source << " with command: " << compile_cmd << '\n';
+        std::remove(building.c_str());
+        return;
+    }
+    if (std::rename(building.c_str(), sharedLib.c_str()) != 0)
+    {
+        std::cerr << "Failed to replace " << sharedLib << '\n';
+        std::remove(building.c_str());
+    }
+}
+
+void RobotWatcher::reload(const std::string& library)
+{
+    int id = registry.find(library);
+    if (id >= 0 && registry.reload(id, directory + "/" + library))
+    {
+        std::cout << "Reloaded " << library << ", new games will use it\n";
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef ROBOT_WATCHER_H
+#define ROBOT_WATCHER_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include "RobotRegistry.h"
+
+// Watches a directory with inotify while a tournament runs. A saved Robot_*.cpp is rebuilt in the
+// background with the same command the spec uses, and a changed lib*.so is handed to the registry,
+// which swaps it in at the next game boundary.
+class RobotWatcher
+{
+public:
+    RobotWatcher(RobotRegistry& registry, const std::string& directory = ".");
+    ~RobotWatcher();
+
+    bool start();
+    void stop();
+
+private:
+    void watchLoop();
+    void rebuild(const std::string& source);
+    void reload(const std::string& library);
+
+    RobotRegistry& registry;
+    std::string directory;
+    int inotifyFd = -1;
+    std::atomic<bool> running{false};
+    std::thread thread;
+};
+
+#endif // ROBOT_WATCHER_H
@@ -1,4 +1,5 @@
 #include "RobotBase.h"
+#include "RobotConfig.h"
 #include "RadarObj.h"
 #include <vector>
 #include <algorithm> // std::any_of
@@ -38,7 +39,7 @@ class Robot_FireBoi : public RobotBase
         }
 
     public:
-        Robot_FireBoi() : RobotBase(2, 5, flamethrower)
+        Robot_FireBoi(int move = 2, int armor = 5, WeaponType weapon = flamethrower) : RobotBase(move, armor, weapon)
         {
             m_name = "Robot_FireBoi";
             
@@ -159,4 +160,10 @@ class Robot_FireBoi : public RobotBase
 extern "C" RobotBase* create_robot() 
 {
     return new Robot_FireBoi();
-}
\ No newline at end of file
+}
+
+// Optional tuner hook: the same robot with another move, armor and weapon
+extern "C" RobotBase* create_robot_with_config(const RobotConfig* config)
+{
+    return new Robot_FireBoi(config->move, config->armor, config->weapon);
+}
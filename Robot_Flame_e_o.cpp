@@ -1,4 +1,5 @@
 #include "RobotBase.h"
+#include "RobotConfig.h"
 #include <cstdlib>
 #include <ctime>
 #include <set>
@@ -66,7 +67,7 @@ private:
     }
 
 public:
-    Robot_Flame_e_o() : RobotBase(2, 5, flamethrower) 
+    Robot_Flame_e_o(int move = 2, int armor = 5, WeaponType weapon = flamethrower) : RobotBase(move, armor, weapon) 
     {
         std::srand(static_cast<unsigned int>(std::time(nullptr))); // Seed for random movement
     }
@@ -176,4 +177,10 @@ public:
 extern "C" RobotBase* create_robot() 
 {
     return new Robot_Flame_e_o();
-}
\ No newline at end of file
+}
+
+// Optional tuner hook: the same robot with another move, armor and weapon
+extern "C" RobotBase* create_robot_with_config(const RobotConfig* config)
+{
+    return new Robot_Flame_e_o(config->move, config->armor, config->weapon);
+}
@@ -1,7 +1,9 @@
 #include "RobotBase.h"
+#include "RobotConfig.h"
 #include <vector>
 #include <iostream>
 #include <algorithm> // For std::find_if
+#include <sstream>
 
 class Robot_Ratboy : public RobotBase 
 {
@@ -39,7 +41,37 @@ private:
     }
 
 public:
-    Robot_Ratboy() : RobotBase(3, 4, railgun) {} // Initialize with 3 movement, 4 armor, railgun
+    Robot_Ratboy(int move = 3, int armor = 4, WeaponType weapon = railgun) : RobotBase(move, armor, weapon) {} // Initialize with 3 movement, 4 armor, railgun
+
+    // Arena checkpoints, see save_robot_state at the bottom
+    void save_state(std::string& state) const
+    {
+        std::ostringstream os;
+        os << m_moving_down << " " << known_obstacles.size();
+        for (const auto& obj : known_obstacles)
+        {
+            os << " " << obj.m_type << " " << obj.m_row << " " << obj.m_col;
+        }
+        state = os.str();
+    }
+
+    bool load_state(const std::string& state)
+    {
+        std::istringstream is(state);
+        size_t count = 0;
+        is >> m_moving_down >> count;
+        // Every obstacle takes at least " M 0 0" of the text, so a bigger count is a corrupt checkpoint
+        if (is.fail() || count > state.size() / 6)
+        {
+            return false;
+        }
+        known_obstacles.assign(count, RadarObj{'.', 0, 0});
+        for (auto& obj : known_obstacles)
+        {
+            is >> obj.m_type >> obj.m_row >> obj.m_col;
+        }
+        return !is.fail();
+    }
 
     // Radar location for scanning in one of the 8 directions
     virtual void get_radar_direction(int& radar_direction) override 
@@ -139,4 +171,21 @@ void get_move_direction(int& move_direction, int& move_distance) override
 extern "C" RobotBase* create_robot() 
 {
     return new Robot_Ratboy();
-}
\ No newline at end of file
+}
+
+// Optional tuner hook: the same robot with another move, armor and weapon
+extern "C" RobotBase* create_robot_with_config(const RobotConfig* config)
+{
+    return new Robot_Ratboy(config->move, config->armor, config->weapon);
+}
+
+// Optional checkpoint hooks, the arena finds them with dlsym
+extern "C" void save_robot_state(RobotBase* robot, std::string& state)
+{
+    static_cast<Robot_Ratboy*>(robot)->save_state(state);
+}
+
+extern "C" bool load_robot_state(RobotBase* robot, const std::string& state)
+{
+    return static_cast<Robot_Ratboy*>(robot)->load_state(state);
+}
@@ -0,0 +1,847 @@
+#include "TestArena.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+
+// Ceilings for the perf tests, generous for an unoptimised build on a busy machine but well under
+// what a hot path that went quadratic or started allocating per cell would take
+constexpr double RADAR_BUDGET_MICROS = 250.0;   // one scan across a 1000x1000 board
+constexpr double GAME_BUDGET_MILLIS = 1000.0;   // 10000 rounds of 4 robots on 20x20
+
+// Walks up and down a column forever and never shoots, so a game only ends at maxRounds
+class PacerBot : public RobotBase
+{
+public:
+    PacerBot() : RobotBase(2, 5, railgun) { m_name = "PacerBot"; }
+
+    void get_radar_direction(int& radar_direction) override { radar_direction = 1 + turn % 8; }
+    void process_radar_results(const std::vector<RadarObj>&) override {}
+    bool get_shot_location(int&, int&) override { return false; }
+    void get_move_direction(int& direction, int& distance) override
+    {
+        direction = ++turn % 2 ? 1 : 5;
+        distance = 1;
+    }
+
+private:
+    int turn = 0;
+};
+
+// Keeps a block of the given size from every radar scan, until told to let them all go
+class HoarderBot : public RobotBase
+{
+public:
+    explicit HoarderBot(size_t bytes) : RobotBase(3, 4, railgun), bytes(bytes)
+    {
+        m_name = "HoarderBot";
+        hoard.reserve(64); // before it's in an arena, so only the blocks are charged
+    }
+
+    bool letGo = false;
+
+    void get_radar_direction(int& radar_direction) override { radar_direction = 1; }
+    void process_radar_results(const std::vector<RadarObj>&) override
+    {
+        if (letGo)
+        {
+            hoard.clear();
+            return;
+        }
+        hoard.emplace_back(bytes);
+    }
+    bool get_shot_location(int&, int&) override { return false; }
+    void get_move_direction(int& direction, int& distance) override
+    {
+        direction = 0;
+        distance = 0;
+    }
+
+private:
+    size_t bytes;
+    std::vector<std::vector<char>> hoard;
+};
+
+} // namespace
+
+TestBot::TestBot(WeaponType weapon, int move, int armor)
+: RobotBase(move, armor, weapon)
+{
+    m_name = "TestBot";
+}
+
+bool TestBot::get_shot_location(int& shot_row, int& shot_col)
+{
+    shot_row = shotRow;
+    shot_col = shotCol;
+    return shooting;
+}
+
+void TestBot::get_move_direction(int& direction, int& distance)
+{
+    direction = moveDirection;
+    distance = moveDistance;
+}
+
+void TestArena::check(bool condition, const std::string& what)
+{
+    if (condition)
+    {
+        ++passed;
+        std::cout << "  PASS  " << what << "\n";
+    }
+    else
+    {
+        ++failed;
+        std::cout << "  FAIL  " << what << "\n";
+    }
+}
+
+ArenaConfig TestArena::quietConfig(int rows, int cols)
+{
+    ArenaConfig config;
+    config.rows = rows;
+    config.cols = cols;
+    config.seed = 42;
+    config.verbose = false;
+    return config;
+}
+
+RobotHandle TestArena::put(Arena& arena, RobotBase* robot, int row, int col)
+{
+    arena.addRobot(robot);
+    RobotHandle handle = arena.robots.handle(static_cast<uint32_t>(arena.robots.slots() - 1));
+    arena.vacateCell(arena.robots.row(handle.slot()), arena.robots.col(handle.slot()));
+    arena.occupyCell(row, col, handle);
+    arena.robots.moveTo(handle.slot(), row, col);
+    return handle;
+}
+
+void TestArena::setCell(Arena& arena, int row, int col, CellType type)
+{
+    arena.setCellType(row, col, type);
+}
+
+int TestArena::health(const Arena& arena, RobotHandle handle)
+{
+    return arena.robots.health(handle.slot());
+}
+
+std::pair<int, int> TestArena::position(const Arena& arena, RobotHandle handle)
+{
+    return { arena.robots.row(handle.slot()), arena.robots.col(handle.slot()) };
+}
+
+void TestArena::test_robot_creation()
+{
+    TestBot plain(railgun, 3, 2);
+    check(plain.get_health() == 100, "robots start on 100 health");
+    check(plain.get_move_speed() == 3 && plain.get_armor() == 2, "move and armor as asked when they fit");
+    check(plain.get_weapon() == railgun && plain.get_grenades() == 0, "railgun robot has no grenades");
+
+    TestBot grenadier(grenade);
+    check(grenadier.get_grenades() == 15, "grenade robot starts with 15 grenades");
+
+    TestBot fast(hammer, 9, 9);
+    check(fast.get_move_speed() == 5 && fast.get_armor() == 2, "move capped at 5, armor at 7 - move");
+
+    TestBot slow(flamethrower, 0, -3);
+    check(slow.get_move_speed() == 2 && slow.get_armor() == 0, "move at least 2, armor at least 0");
+}
+
+void TestArena::test_initialize_board()
+{
+    Arena arena(quietConfig(15, 20));
+    bool empty = true;
+    for (int r = 0; r < 15; ++r)
+    {
+        for (int c = 0; c < 20; ++c)
+        {
+            empty &= arena.grid.at(r, c).type == EMPTY;
+        }
+    }
+    check(arena.rows == 15 && arena.cols == 20 && empty, "a new 15x20 arena is empty");
+
+    Arena again(quietConfig(15, 20));
+    arena.placeObstacles();
+    again.placeObstacles();
+    int obstacles = 0;
+    bool same = true;
+    for (int r = 0; r < 15; ++r)
+    {
+        for (int c = 0; c < 20; ++c)
+        {
+            CellType type = arena.grid.at(r, c).type;
+            obstacles += type != EMPTY;
+            same &= type == again.grid.at(r, c).type;
+        }
+    }
+    check(obstacles > 0 && obstacles < 15 * 20 / 2, "placeObstacles puts down some obstacles");
+    check(same, "the same seed gives the same obstacles");
+
+    RobotHandle handle = put(arena, new TestBot(railgun), 0, 0);
+    check(arena.grid.at(0, 0).type == ROBOT && arena.grid.at(0, 0).robot.raw() == handle.raw(),
+          "a placed robot is on the board");
+}
+
+void TestArena::test_handle_move()
+{
+    Arena arena(quietConfig(10, 10));
+    RobotHandle bot = put(arena, new TestBot(railgun, 3), 5, 2);
+
+    arena.moveRobot(bot, 3, 2);
+    check(position(arena, bot) == std::make_pair(5, 4), "moves right 2");
+    check(arena.grid.at(5, 2).type == EMPTY && arena.grid.at(5, 4).type == ROBOT, "the board follows the move");
+
+    arena.moveRobot(bot, 5, 9);
+    check(position(arena, bot) == std::make_pair(8, 4), "a move is capped at the robot's speed");
+
+    arena.moveRobot(bot, 0, 3);
+    arena.moveRobot(bot, 9, 3);
+    check(position(arena, bot) == std::make_pair(8, 4), "directions outside 1-8 stay put");
+
+    setCell(arena, 8, 6, OBSTACLE_MOUND);
+    arena.moveRobot(bot, 3, 3);
+    check(position(arena, bot) == std::make_pair(8, 5), "a mound stops the move in front of it");
+
+    setCell(arena, 5, 5, OBSTACLE_FLAMETHROWER);
+    arena.moveRobot(bot, 1, 3);
+    check(position(arena, bot) == std::make_pair(5, 5), "a flamethrower doesn't stop the move");
+    check(health(arena, bot) <= 70 && health(arena, bot) >= 50, "landing on a flamethrower burns for 30-50");
+
+    setCell(arena, 3, 5, OBSTACLE_PIT);
+    arena.moveRobot(bot, 1, 3);
+    check(position(arena, bot) == std::make_pair(3, 5), "a pit swallows the robot");
+    check(arena.robots.moveSpeed(bot.slot()) == 0, "a robot in a pit can't move");
+    check(arena.grid.at(5, 5).type == OBSTACLE_FLAMETHROWER, "the flamethrower is back once the robot has left");
+
+    arena.moveRobot(bot, 1, 1);
+    check(position(arena, bot) == std::make_pair(3, 5), "it stays in the pit");
+}
+
+void TestArena::test_handle_collision()
+{
+    Arena arena(quietConfig(10, 10));
+    RobotHandle mover = put(arena, new TestBot(railgun, 4), 2, 2);
+    RobotHandle other = put(arena, new TestBot(railgun), 2, 5);
+
+    arena.moveRobot(mover, 3, 4);
+    check(position(arena, mover) == std::make_pair(2, 4), "stops next to the robot in the way");
+    check(position(arena, other) == std::make_pair(2, 5), "the robot in the way doesn't move");
+
+    arena.moveRobot(mover, 1, 4);
+    check(position(arena, mover) == std::make_pair(0, 4), "stops at the edge of the board");
+
+    setCell(arena, 1, 3, DEAD);
+    arena.moveRobot(mover, 6, 2);
+    check(position(arena, mover) == std::make_pair(0, 4), "a wreck blocks the way like a robot");
+    check(health(arena, mover) == 100 && health(arena, other) == 100, "bumping into things doesn't hurt");
+}
+
+void TestArena::test_radar()
+{
+    Arena arena(quietConfig(10, 10));
+    RobotHandle bot = put(arena, new TestBot(railgun), 5, 2);
+    setCell(arena, 5, 4, OBSTACLE_PIT);
+    setCell(arena, 5, 6, OBSTACLE_MOUND);
+
+    std::vector<RadarObj> seen = arena.simulateRadar(bot, 3);
+    check(seen.size() == 4, "radar to the right goes as far as the mound");
+    check(seen.size() == 4 && seen[0].m_type == '.' && seen[1].m_type == 'P' && seen[1].m_col == 4
+          && seen[3].m_type == 'M' && seen[3].m_row == 5 && seen[3].m_col == 6, "radar reports the pit and the mound");
+
+    put(arena, new TestBot(railgun), 2, 5);
+    seen = arena.simulateRadar(bot, 2);
+    check(!seen.empty() && seen.back().m_type == 'R' && seen.back().m_row == 2 && seen.back().m_col == 5,
+          "radar up and right stops at the robot it finds");
+
+    setCell(arena, 4, 2, DEAD);
+    seen = arena.simulateRadar(bot, 1);
+    check(seen.size() == 1 && seen[0].m_type == 'X', "a wreck blocks the radar");
+}
+
+void TestArena::test_radar_cache()
+{
+    Arena arena(quietConfig(10, 10));
+    RobotHandle bot = put(arena, new TestBot(railgun), 5, 2);
+    setCell(arena, 5, 6, OBSTACLE_MOUND);
+
+    const std::vector<RadarObj>* first = &arena.simulateRadar(bot, 3);
+    check(arena.radarCache.find(5, 2, 3) == first && &arena.simulateRadar(bot, 3) == first,
+          "the same scan from the same cell comes from the cache");
+
+    // Off the ray: behind the robot, beyond the mound, on another line
+    setCell(arena, 5, 0, OBSTACLE_PIT);
+    setCell(arena, 5, 8, OBSTACLE_FLAMETHROWER);
+    setCell(arena, 2, 7, OBSTACLE_MOUND);
+    check(arena.radarCache.find(5, 2, 3) != nullptr, "changes off the ray leave it cached");
+
+    // A robot stepping onto the ray
+    RobotHandle other = put(arena, new TestBot(railgun, 5), 3, 4);
+    arena.moveRobot(other, 5, 2);
+    check(arena.radarCache.find(5, 2, 3) == nullptr, "a robot moving onto the ray throws it away");
+    std::vector<RadarObj> seen = arena.simulateRadar(bot, 3);
+    check(seen.size() == 2 && seen.back().m_type == 'R' && seen.back().m_col == 4, "and the next scan sees it");
+
+    // And dying there
+    arena.beginRound();
+    arena.applyDamageToCell(5, 4, 200, 200);
+    arena.endRound(false);
+    seen = arena.simulateRadar(bot, 3);
+    check(seen.size() == 2 && seen.back().m_type == 'X', "its wreck shows up in place of the robot");
+
+    // The scanning robot moving keys a new ray rather than touching the old one
+    arena.moveRobot(bot, 5, 1);
+    check(arena.radarCache.find(5, 2, 3) != nullptr && arena.radarCache.find(6, 2, 3) == nullptr,
+          "a robot that moves scans from a new cell");
+    check(arena.simulateRadar(bot, 0).empty() && arena.radarCache.find(6, 2, 3) == nullptr,
+          "an invalid direction isn't cached");
+
+    // Diagonals, from (6, 2)
+    arena.simulateRadar(bot, 2);
+    arena.simulateRadar(bot, 4);
+    setCell(arena, 3, 5, OBSTACLE_PIT);
+    check(arena.radarCache.find(6, 2, 2) == nullptr && arena.radarCache.find(6, 2, 4) != nullptr,
+          "a change up and right only throws away the ray that way");
+    setCell(arena, 8, 4, OBSTACLE_PIT);
+    check(arena.radarCache.find(6, 2, 4) == nullptr, "and down and right the same");
+}
+
+void TestArena::test_radar_local()
+{
+    Arena arena(quietConfig(8, 12));
+    TestBot* robot = new TestBot(railgun);
+    RobotHandle bot = put(arena, robot, 0, 0);
+    setCell(arena, 3, 3, OBSTACLE_MOUND);
+
+    robot->radarDirection = 4;
+    arena.simulateTurn(bot);
+    check(robot->lastRadar.size() == 3 && robot->lastRadar.back().m_type == 'M',
+          "a turn hands the robot its radar results");
+
+    robot->radarDirection = 0;
+    arena.simulateTurn(bot);
+    check(robot->lastRadar.empty(), "direction 0 sees nothing");
+
+    bool onBoard = true;
+    for (int direction = 1; direction <= 8; ++direction)
+    {
+        for (const RadarObj& obj : arena.simulateRadar(bot, direction))
+        {
+            onBoard &= obj.m_row >= 0 && obj.m_row < 8 && obj.m_col >= 0 && obj.m_col < 12;
+        }
+    }
+    check(onBoard, "radar from a corner never reports a cell off the board");
+}
+
+void TestArena::test_handle_shot_with_fake_radar()
+{
+    Arena arena(quietConfig(10, 10));
+    TestBot* shooter = new TestBot(railgun);
+    RobotHandle gun = put(arena, shooter, 5, 1);
+    RobotHandle target = put(arena, new TestBot(railgun), 5, 8);
+    setCell(arena, 5, 4, OBSTACLE_MOUND);
+
+    // The robot is told there's an enemy where there is one, and shoots at it
+    shooter->process_radar_results({ RadarObj('R', 5, 8) });
+    shooter->shooting = true;
+    shooter->shotRow = shooter->lastRadar[0].m_row;
+    shooter->shotCol = shooter->lastRadar[0].m_col;
+    shooter->radarDirection = 0;
+    arena.simulateTurn(gun);
+    check(health(arena, target) < 100 && health(arena, target) >= 80, "the railgun goes through the mound and hits");
+    check(position(arena, gun) == std::make_pair(5, 1), "a robot that shoots doesn't move");
+
+    // A fake sighting off to the side: the shot lands on nothing
+    int before = health(arena, target);
+    shooter->shotRow = 0;
+    shooter->shotCol = 1;
+    arena.simulateTurn(gun);
+    check(health(arena, target) == before, "a shot at an empty line hits nobody");
+
+    shooter->shotRow = 5;
+    shooter->shotCol = 1;
+    arena.simulateTurn(gun);
+    check(health(arena, gun) == 100, "shooting at yourself does nothing");
+}
+
+void TestArena::test_robot_with_all_weapons()
+{
+    for (int w = 0; w < weaponCount; ++w)
+    {
+        WeaponType weapon = static_cast<WeaponType>(w);
+        const WeaponSpec& spec = weaponSpecs[w];
+        std::string name = spec.name;
+
+        Arena arena(quietConfig(10, 10));
+        RobotHandle shooter = put(arena, new TestBot(weapon), 5, 5);
+        RobotHandle target = put(arena, new TestBot(railgun, 2, 4), 5, 6);
+        RobotHandle far = put(arena, new TestBot(railgun, 2, 0), 1, 1);
+
+        arena.resolveShot(shooter, 5, 6);
+        int taken = 100 - health(arena, target);
+        check(taken >= armorReducedDamage(spec.damageMin, 4) && taken <= armorReducedDamage(spec.damageMax, 4),
+              name + " hits next door for its damage less armor");
+        check(arena.robots.armor(target.slot()) == 3, name + " wears a point of armor off");
+        check(health(arena, far) == 100, name + " leaves a robot out of the way alone");
+        if (weapon != grenade)
+        {
+            check(health(arena, shooter) == 100, name + " doesn't hurt the shooter");
+        }
+
+        // Out past the weapon's reach
+        int before = health(arena, far);
+        arena.resolveShot(shooter, 1, 1);
+        bool reaches = spec.range == 0 && (spec.shape == ShotShape::Pattern || spec.rayLength == 0 || spec.rayLength >= 4);
+        check(reaches ? health(arena, far) < before : health(arena, far) == before,
+              name + (reaches ? " reaches 4 cells away" : " can't reach 4 cells away"));
+    }
+}
+
+void TestArena::test_grenade_damage()
+{
+    Arena arena(quietConfig(10, 10));
+    RobotHandle grenadier = put(arena, new TestBot(grenade), 1, 1);
+    RobotHandle centre = put(arena, new TestBot(railgun, 2, 0), 6, 6);
+    RobotHandle corner = put(arena, new TestBot(railgun, 2, 0), 7, 7);
+    RobotHandle outside = put(arena, new TestBot(railgun, 2, 0), 6, 8);
+
+    arena.resolveShot(grenadier, 6, 6);
+    check(health(arena, centre) <= 90 && health(arena, centre) >= 60, "the grenade hits the robot it lands on");
+    check(health(arena, corner) <= 90 && health(arena, corner) >= 60, "and the one diagonally next to it");
+    check(health(arena, outside) == 100, "but not one two cells off");
+
+    int before = health(arena, outside);
+    arena.resolveShot(grenadier, 6, 9);
+    check(health(arena, outside) < before, "a grenade on an empty cell still catches its neighbours");
+
+    setCell(arena, 3, 3, OBSTACLE_MOUND);
+    arena.resolveShot(grenadier, 3, 3);
+    check(arena.grid.at(3, 3).type == OBSTACLE_MOUND, "grenades don't clear mounds");
+}
+
+void TestArena::test_weapon_rules()
+{
+    Arena arena(quietConfig(10, 10));
+    RobotHandle grenadier = put(arena, new TestBot(grenade), 1, 1);
+    RobotHandle hammerer = put(arena, new TestBot(hammer), 8, 1);
+    RobotHandle railgunner = put(arena, new TestBot(railgun), 8, 8);
+    RobotHandle target = put(arena, new TestBot(railgun, 2, 0), 5, 5);
+    RobotBase* grenadierRobot = arena.robots.get(grenadier);
+
+    arena.resolveShot(grenadier, 5, 5);
+    check(arena.robots.grenades(grenadier.slot()) == 14 && grenadierRobot->get_grenades() == 14,
+          "a grenade shot spends one grenade");
+
+    arena.resolveShot(grenadier, 1, 1);
+    arena.resolveShot(grenadier, 1, 10);
+    arena.resolveShot(grenadier, -1, 4);
+    check(arena.robots.grenades(grenadier.slot()) == 14, "a shot at itself or off the board spends nothing");
+
+    arena.resolveShot(railgunner, 8, 2);
+    arena.resolveShot(hammerer, 8, 2);
+    check(arena.robots.grenades(railgunner.slot()) == 0 && arena.robots.grenades(hammerer.slot()) == 0,
+          "other weapons have no grenades to spend");
+
+    int before = health(arena, target);
+    arena.resolveShot(hammerer, 5, 5);
+    check(health(arena, target) == before, "a hammer can't swing 3 cells");
+    arena.resolveShot(hammerer, 7, 2);
+    check(arena.robots.armor(target.slot()) == 0 && health(arena, target) == before, "or hit anything in the wrong cell");
+
+    for (int shot = 0; shot < 14; ++shot)
+    {
+        arena.resolveShot(grenadier, 3, 8);
+    }
+    check(arena.robots.grenades(grenadier.slot()) == 0 && grenadierRobot->get_grenades() == 0, "15 grenades and then none");
+    before = health(arena, target);
+    arena.resolveShot(grenadier, 5, 5);
+    check(health(arena, target) == before, "a grenade robot with none left can't hurt anyone");
+    check(arena.robots.grenades(grenadier.slot()) == 0, "and doesn't go below zero");
+}
+
+void TestArena::test_map_file()
+{
+    std::string path = "/tmp/test_arena_map.rwmap";
+    std::string error;
+    ObstacleLayout first(10, 10);
+    first.set(3, 4, OBSTACLE_PIT);
+    check(first.save(path, error), "a map file saves");
+
+    error = "left over from before";
+    std::shared_ptr<const ObstacleLayout> mapped = ObstacleLayout::map(path, error);
+    check(mapped && mapped->at(3, 4) == OBSTACLE_PIT, "and maps back in, whatever was in error already");
+
+    // Saved over while mapped: the arena holding the old map keeps reading it
+    ObstacleLayout second(5, 5);
+    second.set(1, 1, OBSTACLE_MOUND);
+    check(second.save(path, error), "a map file saves over one that's mapped");
+    check(mapped && mapped->rows() == 10 && mapped->at(3, 4) == OBSTACLE_PIT, "the old mapping is left as it was");
+    std::shared_ptr<const ObstacleLayout> remapped = ObstacleLayout::map(path, error);
+    check(remapped && remapped->rows() == 5 && remapped->at(1, 1) == OBSTACLE_MOUND, "mapping it again gets the new one");
+
+    mapped.reset();
+    remapped.reset();
+    std::ofstream(path, std::ios::trunc) << "not a map";
+    error.clear();
+    check(!ObstacleLayout::map(path, error) && !error.empty(), "a file that isn't a map is refused with a reason");
+    std::remove(path.c_str());
+}
+
+void TestArena::test_full_board()
+{
+    // Mounds everywhere but two cells, and three robots to place
+    Arena arena(quietConfig(10, 10));
+    for (int r = 0; r < 10; ++r)
+    {
+        for (int c = 0; c < 10; ++c)
+        {
+            if (!(c == 7 && (r == 1 || r == 2)))
+            {
+                setCell(arena, r, c, OBSTACLE_MOUND);
+            }
+        }
+    }
+    bool first = arena.addRobot(new TestBot(railgun));
+    bool second = arena.addRobot(new TestBot(railgun));
+    check(first && second && arena.grid.at(1, 7).type == ROBOT && arena.grid.at(2, 7).type == ROBOT,
+          "robots still find the last empty cells on a nearly full board");
+    check(!arena.addRobot(new TestBot(railgun)) && arena.robots.slots() == 2, "and one with nowhere to go is turned away");
+
+    // Caves on the default board used to come out almost solid
+    bool roomy = true;
+    for (unsigned seed = 1; seed <= 500; ++seed)
+    {
+        std::mt19937 rng(seed);
+        ObstacleLayout layout = MapGenerator::generate(10, 10, MapStyle::Caves, seed % 2 == 0, rng);
+        int empty = 0;
+        for (int r = 0; r < 10; ++r)
+        {
+            for (int c = 0; c < 10; ++c)
+            {
+                empty += layout.at(r, c) == EMPTY;
+            }
+        }
+        roomy &= empty >= 20;
+    }
+    check(roomy, "generated 10x10 caves leave a fifth of the board empty");
+}
+
+void TestArena::test_symmetric_maps()
+{
+    // Two 3x3 rooms that are each other's rotation, and a short corridor in the middle that is its own
+    const int size = 9;
+    std::vector<uint8_t> cells(size * size, OBSTACLE_MOUND);
+    for (int r = 0; r < 3; ++r)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            cells[r * size + c] = EMPTY;
+            cells[(size - 1 - r) * size + (size - 1 - c)] = EMPTY;
+        }
+    }
+    for (int c = 3; c <= 5; ++c)
+    {
+        cells[4 * size + c] = EMPTY;
+    }
+
+    std::vector<uint8_t> plain = cells;
+    MapGenerator::fillPockets(plain, size, size);
+    check(plain[0] == EMPTY && plain[size * size - 1] == OBSTACLE_MOUND, "a plain fill keeps one room and loses its image");
+
+    uint64_t filled = MapGenerator::fillPockets(cells, size, size, true);
+    bool same = true;
+    for (size_t i = 0; i < cells.size(); ++i)
+    {
+        same &= cells[i] == cells[cells.size() - 1 - i];
+    }
+    check(same && filled == 18 && cells[4 * size + 4] == EMPTY,
+          "a symmetric fill keeps the region that is its own rotation and fills both rooms");
+
+    bool symmetric = true;
+    for (MapStyle style : { MapStyle::Caves, MapStyle::Maze, MapStyle::Clusters })
+    {
+        for (unsigned seed = 1; seed <= 10; ++seed)
+        {
+            std::mt19937 rng(seed);
+            ObstacleLayout layout = MapGenerator::generate(30, 30, style, true, rng);
+            for (int r = 0; r < 30; ++r)
+            {
+                for (int c = 0; c < 30; ++c)
+                {
+                    symmetric &= layout.at(r, c) == layout.at(29 - r, 29 - c);
+                }
+            }
+        }
+    }
+    check(symmetric, "generated symmetric maps are still symmetric after their pockets are filled");
+}
+
+void TestArena::test_worker_protocol()
+{
+    GameResult sent;
+    sent.placement = { 2, 0, 1 };
+    sent.finishRound = { 40, 17, -1 };
+    sent.rounds = 41;
+    sent.draw = false;
+    sent.memory = { RobotMemoryUse{ 5000, 120, false }, RobotMemoryUse{ 9000, 0, true }, RobotMemoryUse{} };
+    std::string payload = WorkerPool::encodeResult(7, sent);
+
+    int id = 0;
+    GameResult got;
+    bool decoded = WorkerPool::decodeResult(payload, id, got);
+    check(decoded && id == 7 && got.rounds == 41 && !got.draw && got.placement == sent.placement &&
+          got.finishRound == sent.finishRound, "a game result comes back the way it went out");
+    bool sameMemory = got.memory.size() == sent.memory.size();
+    for (size_t i = 0; sameMemory && i < got.memory.size(); ++i)
+    {
+        sameMemory = got.memory[i].peak == sent.memory[i].peak && got.memory[i].live == sent.memory[i].live &&
+                     got.memory[i].overCap == sent.memory[i].overCap;
+    }
+    check(sameMemory, "with every robot's heap");
+
+    GameResult ignored;
+    check(!WorkerPool::decodeResult(payload.substr(0, payload.size() - 1), id, ignored), "a result cut short is refused");
+    check(!WorkerPool::decodeResult(payload + "x", id, ignored), "so is one with bytes left over");
+    std::string wrongKind = payload;
+    wrongKind[0] = 'G';
+    check(!WorkerPool::decodeResult(wrongKind, id, ignored), "and a message that isn't a result");
+    std::string garbled = payload;
+    for (size_t i = 9; i < garbled.size(); ++i)
+    {
+        garbled[i] = '\xff';
+    }
+    check(!WorkerPool::decodeResult(garbled, id, ignored), "and one with garbage for its lists");
+}
+
+void TestArena::test_game_phases()
+{
+    // A railgun shooting a sitting target until it dies, played straight through and a phase at a time
+    auto setUp = [](Arena& arena)
+    {
+        TestBot* shooter = new TestBot(railgun);
+        shooter->shooting = true;
+        shooter->shotRow = 5;
+        shooter->shotCol = 8;
+        put(arena, shooter, 5, 5);
+        put(arena, new TestBot(railgun, 2, 0), 5, 8);
+    };
+    Arena straight(quietConfig(10, 10));
+    setUp(straight);
+    GameResult expected = straight.startBattle();
+
+    Arena stepped(quietConfig(10, 10));
+    setUp(stepped);
+    RobotHandle target = stepped.robots.handle(1);
+    GameTask& game = stepped.game();
+    check(game.phase() == GamePhase::Start && stepped.round == 0, "a game doesn't start until it's resumed");
+
+    std::vector<GamePhase> phases;
+    bool unchangedBeforeResolve = true;
+    int atRadar = 0;
+    while (game.resume())
+    {
+        phases.push_back(game.phase());
+        if (game.phase() == GamePhase::Radar)
+        {
+            atRadar = health(stepped, target);
+        }
+        else if (game.phase() == GamePhase::Decide)
+        {
+            unchangedBeforeResolve &= health(stepped, target) == atRadar;
+        }
+        else if (phases.size() == 3)
+        {
+            check(health(stepped, target) < 100, "the first shot lands when the shooter's turn is resolved");
+        }
+    }
+    check(game.done() && game.phase() == GamePhase::Over && !game.resume(), "the game ends and stays ended");
+
+    // Both robots take a turn in every round, the target's last one too if it's still standing
+    bool ordered = true;
+    size_t at = 0;
+    int rounds = 0;
+    while (at < phases.size() && ordered)
+    {
+        for (int turn = 0; turn < 2 && phases[at] != GamePhase::Bookkeeping; ++turn, at += 3)
+        {
+            ordered &= at + 2 < phases.size() && phases[at] == GamePhase::Radar &&
+                       phases[at + 1] == GamePhase::Decide && phases[at + 2] == GamePhase::Resolve;
+        }
+        ordered &= at < phases.size() && phases[at] == GamePhase::Bookkeeping;
+        ++at;
+        ++rounds;
+    }
+    check(ordered && rounds == expected.rounds, "every turn goes radar, decide, resolve and every round ends in bookkeeping");
+    check(unchangedBeforeResolve, "deciding doesn't touch the board");
+
+    GameResult result = stepped.finishBattle();
+    check(result.rounds == expected.rounds && result.placement == expected.placement &&
+          result.finishRound == expected.finishRound,
+          "a game played a phase at a time ends the same as one played straight through");
+}
+
+void TestArena::test_telemetry()
+{
+    ArenaConfig config = quietConfig(10, 10);
+    config.telemetry = std::make_shared<ArenaTelemetry>(10, 10);
+    const ArenaTelemetry& heat = *config.telemetry;
+    Arena arena(config);
+
+    // Right across a flamethrower and into a pit
+    RobotHandle runner = put(arena, new TestBot(railgun, 5, 0), 2, 2);
+    setCell(arena, 2, 4, OBSTACLE_FLAMETHROWER);
+    setCell(arena, 2, 6, OBSTACLE_PIT);
+    arena.moveRobot(runner, 3, 5);
+    check(heat.get(TELEMETRY_FLAMES, 2, 4) == 1, "a flamethrower crossed is counted on its cell");
+    check(heat.get(TELEMETRY_DAMAGE, 2, 4) == static_cast<uint64_t>(100 - health(arena, runner)),
+          "with the damage it did");
+    check(heat.get(TELEMETRY_PITS, 2, 6) == 1 && heat.get(TELEMETRY_VISITS, 2, 6) == 1, "a pit counts the fall and the visit");
+
+    // Stopped short by a mound
+    RobotHandle walker = put(arena, new TestBot(railgun, 3, 0), 5, 5);
+    setCell(arena, 5, 7, OBSTACLE_MOUND);
+    arena.moveRobot(walker, 3, 3);
+    check(heat.get(TELEMETRY_BLOCKS, 5, 7) == 1 && heat.get(TELEMETRY_VISITS, 5, 6) == 1,
+          "a mound counts the move it blocked, the cell before it the visit");
+
+    // Shot dead where it stands, by more than it had left
+    arena.beginRound();
+    arena.applyDamageToCell(5, 6, 200, 200);
+    arena.endRound(false);
+    check(heat.get(TELEMETRY_DAMAGE, 5, 6) == 100 && heat.get(TELEMETRY_DEATHS, 5, 6) == 1,
+          "a kill counts the health the robot lost, not the damage rolled, and the death");
+
+    arena.finishBattle();
+    check(heat.gameCount() == 1, "a finished game is counted");
+
+    std::string error;
+    std::string path = "/tmp/test_arena_heatmap.csv";
+    check(heat.save(path, error), "the heatmap saves as CSV");
+    std::ifstream csv(path);
+    std::string header, line;
+    std::getline(csv, header);
+    int lines = 0;
+    bool found = false;
+    while (std::getline(csv, line))
+    {
+        ++lines;
+        found |= line.rfind("5,6,1,100,1,0,0,0", 0) == 0;
+    }
+    check(header == "row,col,visits,damage,deaths,flames,pits,blocks" && lines == 4 && found,
+          "one CSV line per cell with something on it");
+    std::remove(path.c_str());
+
+    // Another board size is left out rather than written past the end
+    ArenaConfig mismatched = quietConfig(20, 20);
+    mismatched.telemetry = config.telemetry;
+    Arena wrongSize(mismatched);
+    check(!wrongSize.telemetry, "a game on a board of another size isn't recorded");
+}
+
+void TestArena::test_robot_memory()
+{
+    ArenaConfig config = quietConfig(10, 10);
+    config.memoryCap = 4000;
+    Arena arena(config);
+    HoarderBot* hoarder = new HoarderBot(1000);
+    RobotHandle hoard = put(arena, hoarder, 2, 2);
+    RobotHandle frugal = put(arena, new TestBot(railgun), 7, 7);
+    MemoryAccount* hoardAccount = arena.robots.account(hoard.slot());
+
+    arena.beginRound();
+    arena.scanRadar(hoard);
+    RobotMemoryUse use = memoryUse(hoardAccount);
+    check(use.live == 1000 && use.peak == 1000 && !use.overCap, "what a robot allocates in a callback is charged to it");
+    arena.scanRadar(frugal);
+    check(memoryUse(hoardAccount).live == 1000 && memoryUse(arena.robots.account(frugal.slot())).live > 0,
+          "and not what another robot allocates");
+
+    arena.scanRadar(hoard);
+    hoarder->letGo = true;
+    arena.scanRadar(hoard);
+    use = memoryUse(hoardAccount);
+    check(use.live == 0 && use.peak == 2000, "what it frees comes off, the peak stays");
+
+    // Over the cap: shut down after the callback that did it, gone at the end of the round
+    hoarder->letGo = false;
+    for (int scan = 0; scan < 4; ++scan)
+    {
+        arena.scanRadar(hoard);
+    }
+    check(health(arena, hoard) > 0, "a robot at its cap carries on");
+    arena.scanRadar(hoard);
+    check(health(arena, hoard) == 0 && memoryUse(hoardAccount).overCap, "a robot over its cap is shut down");
+    check(!arena.decideTurn(hoard).shooting && arena.decideTurn(hoard).moveDist == 0, "and gets no more turns");
+    arena.endRound(false);
+    check(!arena.robots.get(hoard), "it's cleared away with the dead");
+
+    GameResult result = arena.finishBattle();
+    check(result.memory.size() == 2 && result.memory[0].peak == 5000 && result.memory[0].live == 0 && result.memory[0].overCap,
+          "the result has its peak, and its destructor gave the rest back");
+    check(!result.memory[1].overCap, "the other robot stayed under");
+}
+
+void TestArena::test_radar_performance()
+{
+    Arena arena(quietConfig(1000, 1000));
+    RobotHandle bot = put(arena, new TestBot(railgun), 500, 500);
+
+    // An empty board: every scan runs the full width or height of it. The cache is emptied
+    // first each time so this times the walk.
+    const int scans = 4000;
+    size_t cells = 0;
+    std::chrono::duration<double, std::micro> elapsed{0};
+    for (int i = 0; i < scans; ++i)
+    {
+        arena.radarCache.clear();
+        auto start = std::chrono::steady_clock::now();
+        cells += arena.simulateRadar(bot, 1 + i % 8).size();
+        elapsed += std::chrono::steady_clock::now() - start;
+    }
+    double perScan = elapsed.count() / scans;
+
+    std::cout << "  radar on 1000x1000: " << perScan << "us per scan, " << cells / scans << " cells\n";
+    check(perScan < RADAR_BUDGET_MICROS, "radar on 1000x1000 under " + std::to_string(static_cast<int>(RADAR_BUDGET_MICROS)) + "us");
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < scans; ++i)
+    {
+        cells += arena.simulateRadar(bot, 1 + i % 8).size();
+    }
+    std::chrono::duration<double, std::micro> cachedElapsed = std::chrono::steady_clock::now() - start;
+    double perCachedScan = cachedElapsed.count() / scans;
+    std::cout << "  cached: " << perCachedScan << "us per scan\n";
+    check(perCachedScan * 10 < perScan, "a cached scan is at least 10x faster than the walk");
+}
+
+void TestArena::test_game_performance()
+{
+    ArenaConfig config = quietConfig(20, 20);
+    config.maxRounds = 10000;
+    Arena arena(config);
+    for (int i = 0; i < 4; ++i)
+    {
+        put(arena, new PacerBot(), 4 + 4 * i, 2 + 5 * i);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    GameResult result = arena.startBattle();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "  10000 round game: " << elapsed.count() << "ms\n";
+    check(result.rounds == 10000 && result.draw, "four pacers play out all 10000 rounds");
+    check(elapsed.count() < GAME_BUDGET_MILLIS,
+          "10000 round headless game under " + std::to_string(static_cast<int>(GAME_BUDGET_MILLIS)) + "ms");
+}
+
+void TestArena::print_summary() const
+{
+    std::cout << "\n=== Summary ===\n";
+    std::cout << passed << " passed, " << failed << " failed\n";
+}
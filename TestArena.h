@@ -0,0 +1,72 @@
+#ifndef TEST_ARENA_H
+#define TEST_ARENA_H
+
+#include <string>
+#include <vector>
+#include "Arena.h"
+#include "RobotBase.h"
+
+// A robot that does exactly what the test tells it to and remembers what the radar showed it
+class TestBot : public RobotBase
+{
+public:
+    explicit TestBot(WeaponType weapon, int move = 3, int armor = 0);
+
+    int radarDirection = 1;
+    bool shooting = false;
+    int shotRow = 0, shotCol = 0;
+    int moveDirection = 0, moveDistance = 0;
+    std::vector<RadarObj> lastRadar;
+
+    void get_radar_direction(int& radar_direction) override { radar_direction = radarDirection; }
+    void process_radar_results(const std::vector<RadarObj>& radar_results) override { lastRadar = radar_results; }
+    bool get_shot_location(int& shot_row, int& shot_col) override;
+    void get_move_direction(int& direction, int& distance) override;
+};
+
+// Friend of Arena: builds boards by hand on quiet, seeded arenas and drives the private turn,
+// move, radar and shot code directly. The perf tests put a ceiling on the hot paths so a
+// regression fails the run; the ceilings are for the Makefile's debug build.
+class TestArena
+{
+public:
+    void test_robot_creation();
+    void test_initialize_board();
+    void test_handle_move();
+    void test_handle_collision();
+    void test_radar();
+    void test_radar_cache();
+    void test_radar_local();
+    void test_handle_shot_with_fake_radar();
+    void test_robot_with_all_weapons();
+    void test_grenade_damage();
+    void test_weapon_rules();
+    void test_map_file();
+    void test_full_board();
+    void test_symmetric_maps();
+    void test_worker_protocol();
+    void test_game_phases();
+    void test_telemetry();
+    void test_robot_memory();
+
+    void test_radar_performance();
+    void test_game_performance();
+
+    void print_summary() const;
+    int failures() const { return failed; }
+
+private:
+    int passed = 0;
+    int failed = 0;
+
+    void check(bool condition, const std::string& what);
+
+    static ArenaConfig quietConfig(int rows, int cols);
+    // Load a robot and put it on (row, col), which must be empty
+    static RobotHandle put(Arena& arena, RobotBase* robot, int row, int col);
+    static void setCell(Arena& arena, int row, int col, CellType type);
+    static int health(const Arena& arena, RobotHandle handle);
+    static std::pair<int, int> position(const Arena& arena, RobotHandle handle);
+};
+
+#endif // TEST_ARENA_H
@@ -0,0 +1,79 @@
+#ifndef WEAPONS_H
+#define WEAPONS_H
+
+#include <array>
+#include "RobotBase.h"
+
+// Weapons described as data. Arena::fireWeapon<W> is stamped out once per entry in weaponSpecs,
+// so each weapon gets its own loop with the pattern and damage range baked in. Whether a shot may
+// be fired at all (range, ammunition) is checked from the same table before any of that runs.
+// A new weapon is a new WeaponType plus one more row in the table.
+
+// A cell relative to the point the shot lands on
+struct CellOffset
+{
+    int row;
+    int col;
+};
+
+enum class ShotShape
+{
+    Pattern, // the cells listed in the pattern, around the target
+    Ray      // a line from the shooter through the target, see LineOfFire.h
+};
+
+struct WeaponSpec
+{
+    const char* name;
+    int damageMin;
+    int damageMax;
+    int range;            // furthest target (in king moves) from the shooter, 0 for anywhere
+    bool passesBlockers;  // keeps going through mounds, robots and wrecks
+    ShotShape shape;
+    const CellOffset* pattern;
+    int patternSize;
+    int rayLength;        // Ray: cells from the shooter, 0 for all the way to the edge
+    int rayWidth;         // Ray: lanes side by side (odd)
+    bool usesGrenades;    // every shot spends one of the robot's grenades, none left and it can't fire
+};
+
+// (2R+1) x (2R+1) square centred on the target
+template <int R>
+constexpr std::array<CellOffset, (2 * R + 1) * (2 * R + 1)> boxPattern()
+{
+    std::array<CellOffset, (2 * R + 1) * (2 * R + 1)> cells{};
+    int i = 0;
+    for (int r = -R; r <= R; ++r)
+    {
+        for (int c = -R; c <= R; ++c)
+        {
+            cells[i++] = CellOffset{r, c};
+        }
+    }
+    return cells;
+}
+
+inline constexpr auto grenadePattern = boxPattern<1>();
+inline constexpr auto hammerPattern = boxPattern<0>();
+
+// Indexed by WeaponType
+inline constexpr WeaponSpec weaponSpecs[] =
+{
+    { "flamethrower", 30, 50, 0, false, ShotShape::Ray,     nullptr,               0,                           4, 3, false },
+    { "railgun",      10, 20, 0, true,  ShotShape::Ray,     nullptr,               0,                           0, 1, false },
+    { "grenade",      10, 40, 0, true,  ShotShape::Pattern, grenadePattern.data(), int(grenadePattern.size()), 0, 0, true },
+    { "hammer",       50, 60, 1, true,  ShotShape::Pattern, hammerPattern.data(),  int(hammerPattern.size()),  0, 0, false },
+};
+
+inline constexpr int weaponCount = sizeof(weaponSpecs) / sizeof(weaponSpecs[0]);
+static_assert(weaponCount == hammer + 1, "every WeaponType needs a row in weaponSpecs");
+
+// Damage left after armor, in tenths: each armor point takes 10% off, capped at 4 points.
+inline constexpr int armorScale[] = { 10, 9, 8, 7, 6 };
+
+constexpr int armorReducedDamage(int baseDamage, int armor)
+{
+    return baseDamage * armorScale[armor < 0 ? 0 : (armor > 4 ? 4 : armor)] / 10;
+}
+
+#endif // WEAPONS_H
@@ -0,0 +1,529 @@
+#include "WorkerPool.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "ArenaCheckpoint.h"
+
+extern char** environ;
+
+namespace
+{
+
+// Where a worker finds its end of the socket, and what it is
+constexpr int WORKER_FD = 3;
+constexpr const char* WORKER_EXECUTABLE = "/proc/self/exe";
+
+constexpr char setupMessage = 'S';
+constexpr char gameMessage = 'G';
+constexpr char resultMessage = 'R';
+
+bool writeAll(int fd, const char* data, size_t size)
+{
+    while (size > 0)
+    {
+        // MSG_NOSIGNAL: a worker that died turns into an error here rather than a SIGPIPE
+        ssize_t written = send(fd, data, size, MSG_NOSIGNAL);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool readAll(int fd, char* data, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t got = read(fd, data, size);
+        if (got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (got <= 0)
+        {
+            return false;
+        }
+        data += got;
+        size -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+bool sendMessage(int fd, const std::string& payload)
+{
+    uint32_t size = static_cast<uint32_t>(payload.size());
+    std::string message(reinterpret_cast<const char*>(&size), sizeof(size));
+    message += payload;
+    return writeAll(fd, message.data(), message.size());
+}
+
+// Blocking, for the worker. False when the coordinator has hung up.
+bool receiveMessage(int fd, std::string& payload)
+{
+    uint32_t size;
+    if (!readAll(fd, reinterpret_cast<char*>(&size), sizeof(size)))
+    {
+        return false;
+    }
+    payload.resize(size);
+    return readAll(fd, payload.data(), size);
+}
+
+void putInts(SnapshotWriter& writer, const std::vector<int>& values)
+{
+    writer.put<uint32_t>(static_cast<uint32_t>(values.size()));
+    for (int value : values)
+    {
+        writer.put<int32_t>(value);
+    }
+}
+
+std::vector<int> getInts(SnapshotReader& reader)
+{
+    uint32_t count = reader.get<uint32_t>();
+    std::vector<int> values;
+    for (uint32_t i = 0; i < count && reader.ok(); ++i)
+    {
+        values.push_back(reader.get<int32_t>());
+    }
+    return values;
+}
+
+std::string encodeGame(const MatchSpec& match)
+{
+    SnapshotWriter writer;
+    writer.put<char>(gameMessage);
+    writer.put<int32_t>(match.id);
+    writer.put<uint32_t>(match.seed);
+    putInts(writer, match.robots);
+    return writer.data();
+}
+
+// How a worker went, for the report
+std::string describeExit(int status)
+{
+    if (WIFSIGNALED(status))
+    {
+        return std::string("crashed with ") + strsignal(WTERMSIG(status));
+    }
+    if (WIFEXITED(status))
+    {
+        return "exited with status " + std::to_string(WEXITSTATUS(status));
+    }
+    return "stopped";
+}
+
+} // namespace
+
+WorkerPool::WorkerPool(const std::vector<std::string>& robotLibs, const ArenaConfig& arena, const std::string& mapPath,
+                       int processes, int gameTimeout)
+: processes(std::max(1, processes)), gameTimeout(std::max(0, gameTimeout))
+{
+    SnapshotWriter writer;
+    writer.put<char>(setupMessage);
+    writer.put<uint32_t>(static_cast<uint32_t>(robotLibs.size()));
+    for (const std::string& lib : robotLibs)
+    {
+        writer.putString(lib);
+    }
+    writer.put<int32_t>(arena.rows);
+    writer.put<int32_t>(arena.cols);
+    writer.put<int32_t>(arena.maxRounds);
+    writer.put<uint8_t>(arena.sparseGrid);
+    writer.put<uint8_t>(static_cast<uint8_t>(arena.mapStyle));
+    writer.put<uint8_t>(arena.symmetricMap);
+    writer.put<int64_t>(arena.memoryCap);
+    writer.putString(mapPath);
+    setup = writer.data();
+}
+
+WorkerPool::~WorkerPool()
+{
+    for (Worker& worker : workers)
+    {
+        retire(worker);
+    }
+}
+
+// Start a worker and tell it about the tournament
+bool WorkerPool::spawn(Worker& worker)
+{
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0)
+    {
+        std::cerr << "Cannot make a socket for a worker: " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    // The dup leaves the worker's end open across exec, and nothing else of ours
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], WORKER_FD);
+    std::string name = "RobotWarz", flag = "--worker", fd = std::to_string(WORKER_FD);
+    char* argv[] = { name.data(), flag.data(), fd.data(), nullptr };
+    pid_t pid;
+    int error = posix_spawn(&pid, WORKER_EXECUTABLE, &actions, nullptr, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(fds[1]);
+    if (error != 0)
+    {
+        close(fds[0]);
+        std::cerr << "Cannot start a worker: " << std::strerror(error) << "\n";
+        return false;
+    }
+
+    worker.pid = pid;
+    worker.fd = fds[0];
+    worker.received.clear();
+    worker.games.clear();
+    return sendMessage(worker.fd, setup);
+}
+
+// Hang up on a worker, which it takes as the sign to exit, and collect it. Returns its wait status.
+int WorkerPool::retire(Worker& worker)
+{
+    int status = 0;
+    if (worker.fd >= 0)
+    {
+        close(worker.fd);
+        worker.fd = -1;
+    }
+    if (worker.pid > 0)
+    {
+        while (waitpid(worker.pid, &status, 0) < 0 && errno == EINTR)
+        {
+        }
+        worker.pid = -1;
+    }
+    return status;
+}
+
+void WorkerPool::play(const std::vector<MatchSpec>& matches, const std::function<void(const MatchResult&)>& onResult)
+{
+    std::deque<size_t> waiting;
+    for (size_t i = 0; i < matches.size(); ++i)
+    {
+        waiting.push_back(i);
+    }
+    std::vector<int> attempts(matches.size(), 0);
+    size_t remaining = matches.size();
+
+    auto noContest = [&](size_t index)
+    {
+        onResult(MatchResult{matches[index], GameResult{}});
+        --remaining;
+    };
+
+    // A worker died or stopped making sense. The game it was playing counts an attempt against it,
+    // the ones queued behind it just go back to the front of the line.
+    auto lose = [&](Worker& worker)
+    {
+        if (worker.fd >= 0 && worker.pid > 0)
+        {
+            kill(worker.pid, SIGKILL);
+        }
+        pid_t pid = worker.pid;
+        int status = retire(worker);
+        for (size_t n = worker.games.size(); n-- > 0; )
+        {
+            size_t index = worker.games[n];
+            if (n > 0)
+            {
+                waiting.push_front(index);
+                continue;
+            }
+            std::cerr << "Worker " << pid << " " << describeExit(status) << " in game " << matches[index].id << "\n";
+            if (++attempts[index] < MAX_ATTEMPTS)
+            {
+                waiting.push_front(index);
+            }
+            else
+            {
+                std::cerr << "Game " << matches[index].id << " took down " << MAX_ATTEMPTS << " workers, no contest\n";
+                noContest(index);
+            }
+        }
+        worker.games.clear();
+    };
+
+    workers.resize(static_cast<size_t>(processes));
+    std::vector<pollfd> polls;
+    std::vector<Worker*> polled;
+    char buffer[65536];
+    while (remaining > 0)
+    {
+        // Keep every worker running with its games in flight
+        polls.clear();
+        polled.clear();
+        for (Worker& worker : workers)
+        {
+            if (worker.broken)
+            {
+                continue;
+            }
+            if (worker.fd < 0 && !spawn(worker))
+            {
+                worker.broken = worker.pid < 0;
+                lose(worker);
+                continue;
+            }
+            while (worker.games.size() < GAMES_IN_FLIGHT && !waiting.empty())
+            {
+                size_t index = waiting.front();
+                if (!sendMessage(worker.fd, encodeGame(matches[index])))
+                {
+                    break;
+                }
+                waiting.pop_front();
+                if (worker.games.empty())
+                {
+                    worker.started = std::chrono::steady_clock::now();
+                }
+                worker.games.push_back(index);
+            }
+            polls.push_back(pollfd{worker.fd, POLLIN, 0});
+            polled.push_back(&worker);
+        }
+        if (polls.empty())
+        {
+            std::cerr << "No workers left to play on, " << remaining << " games lost\n";
+            while (!waiting.empty())
+            {
+                size_t index = waiting.front();
+                waiting.pop_front();
+                noContest(index);
+            }
+            return;
+        }
+
+        // Wake up for the first worker to run out of time on its game, if there's a limit
+        int wait = -1;
+        auto now = std::chrono::steady_clock::now();
+        for (Worker* worker : polled)
+        {
+            if (gameTimeout.count() > 0 && !worker->games.empty())
+            {
+                auto left = std::chrono::ceil<std::chrono::milliseconds>(worker->started + gameTimeout - now);
+                int ms = static_cast<int>(std::max<std::chrono::milliseconds::rep>(0, left.count()));
+                wait = wait < 0 ? ms : std::min(wait, ms);
+            }
+        }
+
+        if (poll(polls.data(), polls.size(), wait) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            std::cerr << "Cannot wait on the workers: " << std::strerror(errno) << "\n";
+            return;
+        }
+
+        for (size_t p = 0; p < polls.size(); ++p)
+        {
+            if (polls[p].revents == 0)
+            {
+                continue;
+            }
+            Worker& worker = *polled[p];
+            ssize_t got = read(worker.fd, buffer, sizeof(buffer));
+            if (got < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (got <= 0)
+            {
+                lose(worker);
+                continue;
+            }
+            worker.received.append(buffer, static_cast<size_t>(got));
+
+            // Results come back in the order the games went out
+            bool garbled = false;
+            uint32_t size;
+            while (worker.received.size() >= sizeof(size))
+            {
+                std::memcpy(&size, worker.received.data(), sizeof(size));
+                if (worker.received.size() < sizeof(size) + size)
+                {
+                    break;
+                }
+                std::string payload = worker.received.substr(sizeof(size), size);
+                worker.received.erase(0, sizeof(size) + size);
+
+                MatchResult result;
+                int id;
+                if (worker.games.empty() || !decodeResult(payload, id, result.game) ||
+                    id != matches[worker.games.front()].id)
+                {
+                    garbled = true;
+                    break;
+                }
+                result.match = matches[worker.games.front()];
+                worker.games.erase(worker.games.begin());
+                worker.started = std::chrono::steady_clock::now();
+                --remaining;
+                onResult(result);
+            }
+            if (garbled)
+            {
+                std::cerr << "Worker " << worker.pid << " sent something that isn't a result\n";
+                lose(worker);
+            }
+        }
+
+        // A robot stuck in a loop never lets its worker answer, kill it and play the game again
+        now = std::chrono::steady_clock::now();
+        for (Worker* worker : polled)
+        {
+            if (gameTimeout.count() > 0 && worker->fd >= 0 && !worker->games.empty() &&
+                now - worker->started >= gameTimeout)
+            {
+                std::cerr << "Worker " << worker->pid << " took more than " << gameTimeout.count()
+                          << " seconds over game " << matches[worker->games.front()].id << "\n";
+                lose(*worker);
+            }
+        }
+    }
+}
+
+std::string WorkerPool::encodeResult(int id, const GameResult& result)
+{
+    SnapshotWriter writer;
+    writer.put<char>(resultMessage);
+    writer.put<int32_t>(id);
+    writer.put<int32_t>(result.rounds);
+    writer.put<uint8_t>(result.draw);
+    putInts(writer, result.placement);
+    putInts(writer, result.finishRound);
+    writer.put<uint32_t>(static_cast<uint32_t>(result.memory.size()));
+    for (const RobotMemoryUse& use : result.memory)
+    {
+        writer.put<int64_t>(use.peak);
+        writer.put<int64_t>(use.live);
+        writer.put<uint8_t>(use.overCap);
+    }
+    // The counters are all zero unless built with ARENA_PROFILE, no point sending them then
+    writer.put<uint8_t>(profilingEnabled);
+    if (profilingEnabled)
+    {
+        writer.put(result.profile);
+    }
+    return writer.data();
+}
+
+bool WorkerPool::decodeResult(const std::string& payload, int& id, GameResult& result)
+{
+    SnapshotReader reader(payload.data(), payload.data() + payload.size());
+    if (reader.get<char>() != resultMessage)
+    {
+        return false;
+    }
+    id = reader.get<int32_t>();
+    result.rounds = reader.get<int32_t>();
+    result.draw = reader.get<uint8_t>() != 0;
+    result.placement = getInts(reader);
+    result.finishRound = getInts(reader);
+    uint32_t robots = reader.get<uint32_t>();
+    for (uint32_t i = 0; i < robots && reader.ok(); ++i)
+    {
+        RobotMemoryUse use;
+        use.peak = reader.get<int64_t>();
+        use.live = reader.get<int64_t>();
+        use.overCap = reader.get<uint8_t>() != 0;
+        result.memory.push_back(use);
+    }
+    if (reader.get<uint8_t>())
+    {
+        result.profile = reader.get<ArenaProfile>();
+    }
+    return reader.ok() && reader.done();
+}
+
+int WorkerPool::serve(int fd)
+{
+    RobotRegistry registry;
+    ArenaConfig arena;
+    arena.verbose = false;
+
+    std::string payload;
+    while (receiveMessage(fd, payload))
+    {
+        SnapshotReader reader(payload.data(), payload.data() + payload.size());
+        char kind = reader.get<char>();
+        if (kind == setupMessage)
+        {
+            // Same order as the coordinator's list, so robot indexes are registry ids here too
+            uint32_t count = reader.get<uint32_t>();
+            for (uint32_t i = 0; i < count && reader.ok(); ++i)
+            {
+                registry.add(reader.getString());
+            }
+            arena.rows = reader.get<int32_t>();
+            arena.cols = reader.get<int32_t>();
+            arena.maxRounds = reader.get<int32_t>();
+            arena.sparseGrid = reader.get<uint8_t>() != 0;
+            arena.mapStyle = static_cast<MapStyle>(reader.get<uint8_t>());
+            arena.symmetricMap = reader.get<uint8_t>() != 0;
+            arena.memoryCap = reader.get<int64_t>();
+            std::string mapPath = reader.getString();
+            if (!reader.ok())
+            {
+                std::cerr << "Worker got a message it can't read\n";
+                return 1;
+            }
+            registry.validateAll();
+            if (!mapPath.empty())
+            {
+                std::string error;
+                arena.map = ObstacleLayout::map(mapPath, error);
+                if (!arena.map)
+                {
+                    std::cerr << "Worker cannot load map: " << error << "\n";
+                    return 1;
+                }
+            }
+        }
+        else if (kind == gameMessage)
+        {
+            int id = reader.get<int32_t>();
+            ArenaConfig config = arena;
+            config.seed = reader.get<uint32_t>();
+            std::vector<int> robots = getInts(reader);
+            if (!reader.ok())
+            {
+                std::cerr << "Worker got a message it can't read\n";
+                return 1;
+            }
+
+            Arena game(config);
+            game.placeObstacles();
+            game.loadRobots(registry, robots);
+            if (!sendMessage(fd, encodeResult(id, game.startBattle())))
+            {
+                return 1;
+            }
+        }
+        else
+        {
+            std::cerr << "Worker got a message it can't read\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+#include "MatchScheduler.h"
+
+// Tournament games played in worker processes instead of threads, so a robot that crashes takes
+// down one worker rather than the tournament, and games scale past what one process can carry.
+//
+// Each worker is this same executable started as `RobotWarz --worker FD` with one end of a Unix
+// domain socket on FD. It's told the tournament once (libraries, board, map file) and from then on
+// only gets game specs (id, seed, robots by index) and sends back compact binary results. A worker
+// that dies is replaced and the games it was holding go to another worker; a game that has taken
+// down MAX_ATTEMPTS workers comes back as no contest (an empty GameResult). A worker still on one
+// game after gameTimeout seconds is killed and counts as dying in it, so a robot stuck in a loop
+// can't hold up the tournament.
+//
+// Messages on the socket are a uint32 length and then that many bytes written with SnapshotWriter
+// (ArenaCheckpoint.h), starting with a kind byte:
+//   'S' setup   string libraries..., board settings, map file path ("" for generated maps)
+//   'G' game    int32 id, uint32 seed, int32 robots...
+//   'R' result  int32 id, int32 rounds, bool draw, int32 placement..., int32 finishRound..., profile
+// Both ends are on one host, so values go in host byte order like checkpoints do.
+//
+// Hot reloads (--watch) only reach the coordinator's registry; workers keep the builds they loaded.
+class WorkerPool
+{
+    friend class TestArena;
+
+public:
+    static constexpr int MAX_ATTEMPTS = 3;
+    static constexpr size_t GAMES_IN_FLIGHT = 2; // per worker, so a worker never waits on the next spec
+
+    // mapPath is the file behind arena.map, empty if the arena generates its maps.
+    // gameTimeout is in seconds, 0 for no limit.
+    WorkerPool(const std::vector<std::string>& robotLibs, const ArenaConfig& arena, const std::string& mapPath,
+               int processes, int gameTimeout = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Play every match, calling onResult on this thread as each one comes back
+    void play(const std::vector<MatchSpec>& matches, const std::function<void(const MatchResult&)>& onResult);
+
+    // The worker's side: play games from fd until the coordinator hangs up
+    static int serve(int fd);
+
+private:
+    struct Worker
+    {
+        pid_t pid = -1;
+        int fd = -1;
+        bool broken = false;       // couldn't be started, left out from then on
+        std::string received;      // bytes of a result not all here yet
+        std::vector<size_t> games; // indexes into the matches being played, oldest first
+        std::chrono::steady_clock::time_point started; // when it got on to the oldest game
+    };
+
+    std::string setup;
+    int processes;
+    std::chrono::seconds gameTimeout;
+    std::vector<Worker> workers;
+
+    bool spawn(Worker& worker);
+    int retire(Worker& worker);
+
+    // The 'R' message, both ways. decodeResult is false for anything that isn't a whole result.
+    static std::string encodeResult(int id, const GameResult& result);
+    static bool decodeResult(const std::string& payload, int& id, GameResult& result);
+};
+
+#endif // WORKER_POOL_H
@@ -0,0 +1,275 @@
+#include "Arena.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// A robot that just stands there
+class BenchBot : public RobotBase
+{
+public:
+    explicit BenchBot(WeaponType weapon) : RobotBase(3, 4, weapon) { m_name = "BenchBot"; }
+
+    void get_radar_direction(int& radar_direction) override { radar_direction = 1; }
+    void process_radar_results(const std::vector<RadarObj>&) override {}
+    bool get_shot_location(int&, int&) override { return false; }
+    void get_move_direction(int& direction, int& distance) override { direction = 0; distance = 0; }
+};
+
+// Friend of Arena so it can drive the private hot paths directly
+class ArenaBench
+{
+public:
+    // Shots per second for one weapon, fired from the middle of a board with the usual 10% obstacles
+    static double shotsPerSecond(WeaponType weapon, int size, int shots)
+    {
+        ArenaConfig config;
+        config.rows = size;
+        config.cols = size;
+        config.seed = 1;
+        config.verbose = false;
+
+        Arena arena(config);
+        arena.placeObstacles();
+
+        arena.addRobot(new BenchBot(weapon));
+        arena.addRobot(new BenchBot(railgun));
+
+        RobotHandle shooter = arena.robots.handle(0);
+        int row = arena.robots.row(0);
+        int col = arena.robots.col(0);
+        int targetRow = row == 0 ? 1 : row - 1;
+
+        // Straight to the kernel: resolveShot would stop a grenade robot after its last grenade
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < shots; ++i)
+        {
+            arena.fire(arena.robots.weapon(shooter.slot()), row, col, targetRow, col);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return shots / elapsed.count();
+    }
+
+    // Railgun shots aimed all over a big board, so the line of fire cache sees many directions
+    static double railgunSweep(int size, int shots)
+    {
+        ArenaConfig config;
+        config.rows = size;
+        config.cols = size;
+        config.seed = 1;
+        config.verbose = false;
+
+        Arena arena(config);
+        arena.placeObstacles();
+
+        arena.addRobot(new BenchBot(railgun));
+        RobotHandle shooter = arena.robots.handle(0);
+
+        std::vector<std::pair<int, int>> aims(1024);
+        for (auto& aim : aims)
+        {
+            aim = {arena.randomInt(0, size - 1), arena.randomInt(0, size - 1)};
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < shots; ++i)
+        {
+            const auto& aim = aims[i % aims.size()];
+            arena.resolveShot(shooter, aim.first, aim.second);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return shots / elapsed.count();
+    }
+
+    // Robots moving around a board far too big to allocate whole. Returns moves per second,
+    // and how many megabytes of tiles the grid ended up allocating.
+    static double sparseMoves(int size, int robotCount, int moves, double& megabytes)
+    {
+        ArenaConfig config;
+        config.rows = size;
+        config.cols = size;
+        config.seed = 1;
+        config.verbose = false;
+        config.sparseGrid = true;
+
+        Arena arena(config);
+        for (int i = 0; i < robotCount; ++i)
+        {
+            arena.addRobot(new BenchBot(hammer));
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < moves; ++i)
+        {
+            size_t index = i % arena.robots.livingCount();
+            arena.moveRobot(arena.robots.livingAt(index), arena.randomInt(1, 8), arena.robots.moveSpeed(arena.robots.livingAt(index).slot()));
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        megabytes = arena.grid.allocatedTiles() * arena.grid.tileBytes() / (1024.0 * 1024.0);
+        return moves / elapsed.count();
+    }
+
+    // Memory one arena keeps for its board (grid and jump tables) after some moves on a map,
+    // either with its own copy of the obstacles or on the map's shared ones
+    static double boardMegabytes(const std::shared_ptr<const ObstacleLayout>& layout, bool shared, int robotCount, int moves)
+    {
+        ArenaConfig config;
+        config.rows = layout->rows();
+        config.cols = layout->cols();
+        config.seed = 1;
+        config.verbose = false;
+        if (shared)
+        {
+            config.map = layout;
+        }
+
+        Arena arena(config);
+        if (shared)
+        {
+            arena.placeObstacles();
+        }
+        else
+        {
+            arena.loadObstacles(*layout);
+        }
+        for (int i = 0; i < robotCount; ++i)
+        {
+            arena.addRobot(new BenchBot(hammer));
+        }
+        for (int i = 0; i < moves; ++i)
+        {
+            size_t index = i % arena.robots.livingCount();
+            arena.moveRobot(arena.robots.livingAt(index), arena.randomInt(1, 8), arena.robots.moveSpeed(arena.robots.livingAt(index).slot()));
+        }
+        return (arena.grid.bytes() + arena.jumps.bytes()) / (1024.0 * 1024.0);
+    }
+
+    // Default 10x10 games played one after another. Returns game rounds per second: games run
+    // longer or shorter with the robots' rand(), so games per second alone doesn't compare.
+    static double smallGameRoundsPerSecond(RobotRegistry& registry, const std::vector<int>& ids, int games, bool heatmap = false)
+    {
+        ArenaConfig config;
+        config.verbose = false;
+        if (heatmap)
+        {
+            config.telemetry = std::make_shared<ArenaTelemetry>(config.rows, config.cols);
+        }
+
+        long long rounds = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int g = 0; g < games; ++g)
+        {
+            config.seed = g + 1;
+            Arena arena(config);
+            arena.placeObstacles();
+            arena.loadRobots(registry, ids);
+            rounds += arena.startBattle().rounds;
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return rounds / elapsed.count();
+    }
+};
+
+// Game thread nanoseconds per logged line, through a sink and formatted on the spot the way the
+// arena used to. Both write to a stream that throws the text away. The sink gets bursts that fit
+// its ring with a drain in between, like rounds of a game; on a single core a ring that fills up
+// makes the game wait for the writer, which is timing the writer instead.
+void logNanoseconds(int events, double& queued, double& inline_)
+{
+    std::ostream discard(nullptr);
+    std::string name = "Robot_Flame_e_o";
+    {
+        const int burst = 4096;
+        LogSink sink(discard);
+        uint32_t source = sink.open("bench");
+        std::chrono::duration<double, std::nano> elapsed{0};
+        for (int done = 0; done < events; done += burst)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = done; i < std::min(done + burst, events); ++i)
+            {
+                sink.push(source, LogEvent::Turn, name, 100 - i % 100, i % 10, i % 7);
+                if (i % 64 == 63)
+                {
+                    sink.push(source, LogEvent::Flush);
+                }
+            }
+            elapsed += std::chrono::steady_clock::now() - start;
+            sink.drain();
+        }
+        queued = elapsed.count() / events;
+    }
+
+    std::ostringstream text;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < events; ++i)
+    {
+        text << name << "'s turn:\t" << 100 - i % 100 << "/100\t" << "(" << i % 7 << "," << i % 10 << ")\n";
+        if (i % 64 == 63)
+        {
+            discard << text.str();
+            text.str({});
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    inline_ = elapsed.count() / events;
+}
+
+int main(int argc, char* argv[])
+{
+    int size = argc > 1 ? std::stoi(argv[1]) : 100;
+    int shots = argc > 2 ? std::stoi(argv[2]) : 200000;
+
+    std::cout << "Shots per second on a " << size << "x" << size << " arena\n";
+    for (int weapon = 0; weapon < weaponCount; ++weapon)
+    {
+        double rate = ArenaBench::shotsPerSecond(static_cast<WeaponType>(weapon), size, shots);
+        std::cout << std::left << std::setw(14) << weaponSpecs[weapon].name
+                  << std::right << std::setw(14) << static_cast<long long>(rate) << "\n";
+    }
+
+    std::cout << "\nRailgun shots per second on a 2000x2000 arena, random aim\n";
+    std::cout << std::left << std::setw(14) << "railgun" << std::right << std::setw(14)
+              << static_cast<long long>(ArenaBench::railgunSweep(2000, shots / 20)) << "\n";
+
+    double megabytes = 0;
+    double moveRate = ArenaBench::sparseMoves(100000, 1000, shots, megabytes);
+    std::cout << "\nMoves per second on a sparse 100000x100000 arena, 1000 robots\n";
+    std::cout << std::left << std::setw(14) << "move" << std::right << std::setw(14)
+              << static_cast<long long>(moveRate) << "\n";
+    std::cout << std::left << std::setw(14) << "tiles (MB)" << std::right << std::setw(14)
+              << static_cast<long long>(megabytes) << "\n";
+
+    std::mt19937 rng(1);
+    auto layout = std::make_shared<const ObstacleLayout>(ObstacleLayout::scatter(1000, 1000, rng));
+    std::cout << "\nBoard memory per arena on a 1000x1000 map, 8 robots, 10000 moves (MB)\n";
+    std::cout << std::left << std::setw(14) << "own copy" << std::right << std::setw(14) << std::fixed
+              << std::setprecision(2) << ArenaBench::boardMegabytes(layout, false, 8, 10000) << "\n";
+    std::cout << std::left << std::setw(14) << "shared map" << std::right << std::setw(14)
+              << ArenaBench::boardMegabytes(layout, true, 8, 10000) << "\n";
+
+    double queued = 0, formatted = 0;
+    logNanoseconds(shots * 5, queued, formatted);
+    std::cout << "\nNanoseconds per turn log line on the game thread\n";
+    std::cout << std::left << std::setw(14) << "log sink" << std::right << std::setw(14) << queued << "\n";
+    std::cout << std::left << std::setw(14) << "formatted" << std::right << std::setw(14) << formatted << "\n";
+
+    // Needs the robot libraries from `make robots`
+    RobotRegistry registry;
+    std::vector<int> ids;
+    for (const char* lib : { "./libRobot_FireBoi.so", "./libRobot_Flame_e_o.so", "./libRobot_Ratboy.so" })
+    {
+        ids.push_back(registry.add(lib));
+        ids.push_back(registry.add(lib));
+    }
+    if (registry.validateAll() == static_cast<int>(ids.size()))
+    {
+        std::cout << "\nGame rounds per second, 500 10x10 games with 6 robots\n";
+        std::cout << std::left << std::setw(14) << "plain" << std::right << std::setw(14)
+                  << static_cast<long long>(ArenaBench::smallGameRoundsPerSecond(registry, ids, 500)) << "\n";
+        std::cout << std::left << std::setw(14) << "with heatmap" << std::right << std::setw(14)
+                  << static_cast<long long>(ArenaBench::smallGameRoundsPerSecond(registry, ids, 500, true)) << "\n";
+    }
+    return 0;
+}
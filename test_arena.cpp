@@ -22,6 +22,7 @@ int main() {
 
     //test radar
     tester.test_radar();
+    tester.test_radar_cache();
     tester.test_radar_local();
 
     // Test BadRobot with all weapon configurations
@@ -29,10 +30,33 @@ int main() {
     tester.test_handle_shot_with_fake_radar();
     tester.test_robot_with_all_weapons();
     tester.test_grenade_damage();
+    tester.test_weapon_rules();
 
+    std::cout << "\n=== Testing Map Files ===\n";
+    tester.test_map_file();
+    tester.test_symmetric_maps();
+    tester.test_full_board();
+
+    std::cout << "\n=== Testing Worker Protocol ===\n";
+    tester.test_worker_protocol();
+
+    // The game loop a phase at a time
+    std::cout << "\n=== Testing Game Phases ===\n";
+    tester.test_game_phases();
+
+    std::cout << "\n=== Testing Telemetry ===\n";
+    tester.test_telemetry();
+
+    std::cout << "\n=== Testing Robot Memory ===\n";
+    tester.test_robot_memory();
+
+    // Hot path ceilings, a regression fails the run
+    std::cout << "\n=== Testing Performance ===\n";
+    tester.test_radar_performance();
+    tester.test_game_performance();
 
 	//print the summary
 	tester.print_summary();
 
-    return 0;
+    return tester.failures() == 0 ? 0 : 1;
 }
@@ -1,13 +1,12 @@
 #include "RobotBase.h"
+#include "RobotFuzzer.h"
 #include <iostream>
 #include <vector>
 #include <dlfcn.h>
 #include <algorithm>
 
-RobotBase* load_robot(const std::string& shared_lib, void* &handle) 
+RobotFactory load_factory(const std::string& shared_lib, void* &handle) 
 {
-    std::cout << "Testing robot from " << shared_lib << "...\n";
-
     // Dynamically load the shared library
     handle = dlopen(shared_lib.c_str(), RTLD_LAZY);
     if (!handle) 
@@ -26,6 +25,19 @@ RobotBase* load_robot(const std::string& shared_lib, void* &handle)
         return nullptr;
     }
 
+    return create_robot;
+}
+
+RobotBase* load_robot(const std::string& shared_lib, void* &handle) 
+{
+    std::cout << "Testing robot from " << shared_lib << "...\n";
+
+    RobotFactory create_robot = load_factory(shared_lib, handle);
+    if (!create_robot) 
+    {
+        return nullptr;
+    }
+
     // Instantiate the robot - it will need to be deleted later. This actually calls the function that exists
     // in the ROBOT code! Cool huh! It's in the bottom of the Robot where it says extern "C"
     RobotBase* robot = create_robot();
@@ -141,8 +153,77 @@ void test_robot_behavior(RobotBase* robot)
 
 
 
+// Compile a Robot_.cpp file into its shared library, libRobot_.so
+bool compile_robot(const std::string& robot_file, const std::string& shared_lib)
+{
+    // Compile the robot into a shared library -fPIC is Position Independant Code - look it up!
+    // we're also linking a pre-compiled RobotBase.o - problems will arise if there is a mismatch...
+    std::string compile_cmd = "g++ -shared -fPIC -o " + shared_lib + " " + robot_file + " RobotBase.o -I. -std=c++20";
+    std::cout << "Compiling " << robot_file << " into " << shared_lib << "...\n";
+
+    if (std::system(compile_cmd.c_str()) != 0) {
+        std::cerr << "Failed to compile " << robot_file << " into " << shared_lib << '\n';
+        return false;
+    }
+
+    std::cout << "Success!" << std::endl;
+    return true;
+}
+
+// test_robot --fuzz <Robot_.cpp or libRobot_.so> [--seconds N] [--seed N] [--max-board N] [--slow-us N] [--hang-ms N]
+int fuzz(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " --fuzz <robot_file or robot_library> [--seconds N] [--seed N] "
+                  << "[--max-board N] [--slow-us N] [--hang-ms N]\n";
+        return 1;
+    }
+
+    std::string robot_file = argv[2];
+    std::string shared_lib = robot_file;
+    if (robot_file.size() > 4 && robot_file.substr(robot_file.size() - 4) == ".cpp")
+    {
+        shared_lib = "lib" + robot_file.substr(0, robot_file.find(".cpp")) + ".so";
+        if (!compile_robot(robot_file, shared_lib))
+        {
+            return 1;
+        }
+    }
+    if (shared_lib.find('/') == std::string::npos)
+    {
+        shared_lib = "./" + shared_lib; // dlopen only looks in the current directory when told to
+    }
+
+    FuzzConfig config;
+    for (int i = 3; i + 1 < argc; i += 2)
+    {
+        std::string arg = argv[i];
+        if (arg == "--seconds")        config.seconds = std::stod(argv[i + 1]);
+        else if (arg == "--seed")      config.seed = std::stoul(argv[i + 1]);
+        else if (arg == "--max-board") config.maxBoard = std::stoi(argv[i + 1]);
+        else if (arg == "--slow-us")   config.slowNanos = std::stoll(argv[i + 1]) * 1000;
+        else if (arg == "--hang-ms")   config.hangMillis = std::stoll(argv[i + 1]);
+    }
+
+    void* handle;
+    RobotFactory create_robot = load_factory(shared_lib, handle);
+    if (!create_robot)
+    {
+        return 1;
+    }
+    int result = fuzzRobot(create_robot, config);
+    dlclose(handle);
+    return result;
+}
+
 int main(int argc, char* argv[]) 
 {
+    if (argc > 1 && std::string(argv[1]) == "--fuzz")
+    {
+        return fuzz(argc, argv);
+    }
+
     //argv[1] should contain the name of the Robot_.cpp file to load.
 
     if (argc != 2) 
@@ -154,18 +235,11 @@ int main(int argc, char* argv[])
     const std::string robot_file = argv[1];
     const std::string shared_lib = "lib" + robot_file.substr(0, robot_file.find(".cpp")) + ".so";
 
-    // Compile the robot into a shared library -fPIC is Position Independant Code - look it up!
-    // we're also linking a pre-compiled RobotBase.o - problems will arise if there is a mismatch...
-    std::string compile_cmd = "g++ -shared -fPIC -o " + shared_lib + " " + robot_file + " RobotBase.o -I. -std=c++20";
-    std::cout << "Compiling " << robot_file << " into " << shared_lib << "...\n";
-
-    if (std::system(compile_cmd.c_str()) != 0) {
-        std::cerr << "Failed to compile " << robot_file << " into " << shared_lib << '\n';
+    if (!compile_robot(robot_file, shared_lib))
+    {
         return 1;
     }
 
-    std::cout << "Success!" << std::endl;
-
     RobotBase *robot;
     void *handle;
 